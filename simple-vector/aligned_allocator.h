@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include "simple_vector.h"
+
+// Аллокатор, выравнивающий каждый блок по kAlignment байт (например, 64 - по линии кэша
+// и ширине регистра AVX-512). SimpleVector с таким аллокатором сохраняет выравнивание
+// начала данных при любой реаллокации в PushBack, Reserve и Resize
+template <typename Type, size_t kAlignment = 64>
+class AlignedAllocator {
+public:
+    using value_type = Type;
+    using is_always_equal = std::true_type;
+
+    static_assert(kAlignment >= alignof(Type), "alignment must not be weaker than alignof(Type)");
+    static_assert((kAlignment & (kAlignment - 1)) == 0, "alignment must be a power of two");
+
+    // Выравнивание, которое аллокатор гарантирует для начала блока
+    static constexpr size_t kBlockAlignment = kAlignment;
+
+    template <typename Other>
+    struct rebind {
+        using other = AlignedAllocator<Other, kAlignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename Other>
+    AlignedAllocator(const AlignedAllocator<Other, kAlignment>&) noexcept {
+    }
+
+    Type* allocate(size_t size) {
+        if(size > std::numeric_limits<size_t>::max() / sizeof(Type)){
+            throw std::bad_array_new_length();
+        }
+        return static_cast<Type*>(::operator new(size * sizeof(Type), std::align_val_t(kAlignment)));
+    }
+
+    void deallocate(Type* ptr, size_t) noexcept {
+        ::operator delete(ptr, std::align_val_t(kAlignment));
+    }
+};
+
+template <typename Type, typename Other, size_t kAlignment>
+bool operator==(const AlignedAllocator<Type, kAlignment>&, const AlignedAllocator<Other, kAlignment>&) noexcept {
+    return true;
+}
+
+template <typename Type, typename Other, size_t kAlignment>
+bool operator!=(const AlignedAllocator<Type, kAlignment>&, const AlignedAllocator<Other, kAlignment>&) noexcept {
+    return false;
+}
+
+// SimpleVector, начало данных которого выровнено по kAlignment байт
+template <typename Type, size_t kAlignment = 64>
+using AlignedSimpleVector = SimpleVector<Type, AlignedAllocator<Type, kAlignment>>;
@@ -1,78 +1,376 @@
-﻿#include <cassert>
+﻿#pragma once
+
+#include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
+#include "constexpr_support.h"
+
+// Тип можно перенести в другую память побайтовым копированием, не вызывая
+// конструктор перемещения и деструктор исходного объекта.
+// По умолчанию это тривиально копируемые типы; собственные типы
+// (например, хранящие только указатель на кучу) могут специализировать шаблон
+template <typename Type>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<Type> {
+};
+
 template <typename Type>
+inline constexpr bool kIsTriviallyRelocatable = IsTriviallyRelocatable<Type>::value;
+
+namespace detail {
+
+// Аллокатор умеет менять размер блока на месте (как realloc):
+// Type* Reallocate(Type* ptr, size_t old_size, size_t new_size)
+template <typename Alloc, typename = void>
+struct HasReallocate : std::false_type {
+};
+
+template <typename Alloc>
+struct HasReallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().Reallocate(
+        std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>> : std::true_type {
+};
+
+// Выравнивание начала блока, которое гарантирует аллокатор:
+// Alloc::kBlockAlignment, если он объявлен, иначе alignof(value_type)
+template <typename Alloc, typename = void>
+struct BlockAlignment : std::integral_constant<size_t, alignof(typename Alloc::value_type)> {
+};
+
+template <typename Alloc>
+struct BlockAlignment<Alloc, std::void_t<decltype(Alloc::kBlockAlignment)>>
+    : std::integral_constant<size_t, Alloc::kBlockAlignment> {
+};
+
+// Аллокатор объявляет собственный construct(ptr, value)
+template <typename Alloc, typename = void>
+struct HasConstructMember : std::false_type {
+};
+
+template <typename Alloc>
+struct HasConstructMember<Alloc, std::void_t<decltype(std::declval<Alloc&>().construct(
+        std::declval<typename Alloc::value_type*>(), std::declval<const typename Alloc::value_type&>()))>>
+    : std::true_type {
+};
+
+template <typename Alloc>
+struct IsStdAllocator : std::is_same<Alloc, std::allocator<typename Alloc::value_type>> {
+};
+
+// allocator_traits::construct сводится к размещающему new: аллокатор не объявляет
+// construct (MallocAllocator, MmapAllocator) или это std::allocator
+template <typename Alloc>
+inline constexpr bool kHasDefaultConstruct = std::disjunction_v<IsStdAllocator<Alloc>,
+                                                                std::negation<HasConstructMember<Alloc>>>;
+
+// Копирование [first, last) в неинициализированную память можно заменить memcpy:
+// источник - указатель на тот же тривиально копируемый тип, construct не переопределён
+template <typename Alloc, typename InputIt, typename Type>
+inline constexpr bool kCopiesBytes = std::is_pointer_v<InputIt>
+    && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<InputIt>>, Type>
+    && std::is_trivially_copyable_v<Type> && kHasDefaultConstruct<Alloc>;
+
+} // namespace detail
+
+// Владеет сырой (неинициализированной) памятью под массив элементов типа Type,
+// выделенной аллокатором Alloc.
+// ArrayPtr не вызывает ни конструкторов, ни деструкторов элементов:
+// за их время жизни отвечает владелец (SimpleVector)
+template <typename Type, typename Alloc = std::allocator<Type>>
 class ArrayPtr {
 public:
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, Type>,
+                  "Alloc::value_type must be the same as Type");
+
     // Инициализирует ArrayPtr нулевым указателем
     ArrayPtr() = default;
 
-    // Создаёт в куче массив из size элементов типа Type.
+    SIMPLE_VECTOR_CONSTEXPR explicit ArrayPtr(const Alloc& alloc) noexcept
+        :alloc_(alloc)
+    {
+    }
+
+    // Выделяет неинициализированную память под size элементов типа Type.
     // Если size == 0, поле raw_ptr_ должно быть равно nullptr
-    explicit ArrayPtr(size_t size) {
-        raw_ptr_ = size == 0 ? nullptr : new Type[size];
+    SIMPLE_VECTOR_CONSTEXPR explicit ArrayPtr(size_t size, const Alloc& alloc = Alloc())
+        :alloc_(alloc)
+    {
+        raw_ptr_ = size == 0 ? nullptr : AllocTraits::allocate(alloc_, size);
+        size_ = size;
     }
 
-    // Конструктор из сырого указателя, хранящего адрес массива в куче либо nullptr
-    explicit ArrayPtr(Type* raw_ptr) noexcept {
-        raw_ptr_ = raw_ptr;
+    // Конструктор из сырого указателя на память под size элементов,
+    // выделенную аллокатором, равным alloc, либо nullptr
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr(Type* raw_ptr, size_t size, const Alloc& alloc = Alloc()) noexcept
+        :alloc_(alloc)
+        ,raw_ptr_(raw_ptr)
+        ,size_(raw_ptr == nullptr ? 0 : size)
+    {
     }
 
     // Запрещаем копирование
     ArrayPtr(const ArrayPtr&) = delete;
 
-    ArrayPtr(ArrayPtr&& other){
-        raw_ptr_ = std::exchange(other.raw_ptr_, nullptr);
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr(ArrayPtr&& other) noexcept
+        :alloc_(std::move(other.alloc_))
+        ,raw_ptr_(std::exchange(other.raw_ptr_, nullptr))
+        ,size_(std::exchange(other.size_, 0))
+    {
     };
 
-    ~ArrayPtr() {
-        delete[] raw_ptr_;
-        //raw_ptr_=nullptr;
+    SIMPLE_VECTOR_CONSTEXPR ~ArrayPtr() {
+        Deallocate();
     }
 
     // Запрещаем присваивание
     ArrayPtr& operator=(const ArrayPtr&) = delete;
 
-    ArrayPtr& operator=(ArrayPtr&& other){
-        raw_ptr_ = std::exchange(other.raw_ptr_, nullptr);
+    // Память всегда освобождается тем аллокатором, которым была выделена,
+    // поэтому вместе с указателем переносится и аллокатор.
+    // Неприсваиваемые аллокаторы (polymorphic_allocator) должны быть равны
+    SIMPLE_VECTOR_CONSTEXPR ArrayPtr& operator=(ArrayPtr&& other) noexcept {
+        if(this != &other){
+            Deallocate();
+            if constexpr (std::is_move_assignable_v<Alloc>) {
+                alloc_ = std::move(other.alloc_);
+            } else {
+                assert(alloc_ == other.alloc_);
+            }
+            raw_ptr_ = std::exchange(other.raw_ptr_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
         return *this;
     };
 
     // Прекращает владением массивом в памяти, возвращает значение адреса массива
     // После вызова метода указатель на массив должен обнулиться
-    [[nodiscard]] Type* Release() noexcept {
-        Type* tmp = raw_ptr_;
-        raw_ptr_ = nullptr;
-        return tmp;
+    [[nodiscard]] SIMPLE_VECTOR_CONSTEXPR Type* Release() noexcept {
+        size_ = 0;
+        return std::exchange(raw_ptr_, nullptr);
     }
 
     // Возвращает ссылку на элемент массива с индексом index
-    Type& operator[](size_t index) noexcept {
+    SIMPLE_VECTOR_CONSTEXPR Type& operator[](size_t index) noexcept {
         return raw_ptr_[index];
     }
 
     // Возвращает константную ссылку на элемент массива с индексом index
-    const Type& operator[](size_t index) const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR const Type& operator[](size_t index) const noexcept {
         return const_cast<Type&>(raw_ptr_[index]);
     }
 
     // Возвращает true, если указатель ненулевой, и false в противном случае
-    explicit operator bool() const {
+    SIMPLE_VECTOR_CONSTEXPR explicit operator bool() const {
         return raw_ptr_ != nullptr;
     }
 
     // Возвращает значение сырого указателя, хранящего адрес начала массива
-    Type* Get() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR Type* Get() const noexcept {
         return raw_ptr_;
     }
 
-    // Обменивается значениям указателя на массив с объектом other
-    void swap(ArrayPtr& other) noexcept {
-        std::swap(raw_ptr_, other.raw_ptr_);
+    // Возвращает количество элементов, под которое выделена память
+    SIMPLE_VECTOR_CONSTEXPR size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Alloc& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    // Изменяет размер выделенной памяти через Alloc::Reallocate, по возможности на месте.
+    // Содержимое переносится побайтово, поэтому годится только для IsTriviallyRelocatable-типов
+    void Reallocate(size_t new_size) {
+        static_assert(detail::HasReallocate<Alloc>::value, "Alloc must provide Reallocate");
+        if(new_size == 0){
+            Deallocate();
+            raw_ptr_ = nullptr;
+        } else {
+            raw_ptr_ = alloc_.Reallocate(raw_ptr_, size_, new_size);
+        }
+        size_ = new_size;
+    }
+
+    // Обменивается массивом (вместе с аллокатором) с объектом other.
+    // Необмениваемые аллокаторы (polymorphic_allocator) должны быть равны
+    SIMPLE_VECTOR_CONSTEXPR void swap(ArrayPtr& other) noexcept {
+        using std::swap;
+        if constexpr (std::is_swappable_v<Alloc>) {
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
+        swap(raw_ptr_, other.raw_ptr_);
+        swap(size_, other.size_);
     }
 
 private:
+    SIMPLE_VECTOR_CONSTEXPR void Deallocate() noexcept {
+        if(raw_ptr_ != nullptr){
+            AllocTraits::deallocate(alloc_, raw_ptr_, size_);
+        }
+    }
+
+    Alloc alloc_;
     Type* raw_ptr_ = nullptr;
+    size_t size_ = 0;
 };
+
+namespace detail {
+
+// Аналоги алгоритмов std::uninitialized_*, конструирующие и разрушающие элементы
+// через std::allocator_traits. Это позволяет аллокатору (например, polymorphic_allocator)
+// передать себя вложенным контейнерам. При исключении уже созданные элементы разрушаются
+
+template <typename Alloc, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void Destroy(Alloc& alloc, Type* first, Type* last) noexcept {
+    for(; first != last; ++first){
+        std::allocator_traits<Alloc>::destroy(alloc, first);
+    }
+}
+
+template <typename Alloc, typename Type, typename... Args>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedConstruct(Alloc& alloc, Type* first, Type* last, const Args&... args) {
+    Type* cur = first;
+    try {
+        for(; cur != last; ++cur){
+            std::allocator_traits<Alloc>::construct(alloc, cur, args...);
+        }
+    } catch (...) {
+        Destroy(alloc, first, cur);
+        throw;
+    }
+}
+
+// Инициализирует [first, last) по умолчанию (Type x;), а не значением (Type x{};).
+// allocator_traits::construct без аргументов инициализирует значением, поэтому
+// размещающий new используется, только если construct аллокатора не переопределён
+template <typename Alloc, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void UninitializedDefaultConstruct(Alloc& alloc, Type* first, Type* last) {
+    if constexpr (kHasDefaultConstruct<Alloc>) {
+        if(!IsConstantEvaluated()){
+            Type* cur = first;
+            try {
+                for(; cur != last; ++cur){
+                    ::new (static_cast<void*>(cur)) Type;
+                }
+            } catch (...) {
+                Destroy(alloc, first, cur);
+                throw;
+            }
+            return;
+        }
+    }
+    UninitializedConstruct(alloc, first, last);
+}
+
+template <typename Alloc, typename InputIt, typename Type>
+SIMPLE_VECTOR_CONSTEXPR Type* UninitializedCopy(Alloc& alloc, InputIt first, InputIt last, Type* dest) {
+    if constexpr (kCopiesBytes<Alloc, InputIt, Type>) {
+        if(!IsConstantEvaluated()){
+            const size_t count = static_cast<size_t>(last - first);
+            if(count != 0){
+                std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(Type));
+            }
+            return dest + count;
+        }
+    }
+    Type* cur = dest;
+    try {
+        for(; first != last; ++first, ++cur){
+            std::allocator_traits<Alloc>::construct(alloc, cur, *first);
+        }
+    } catch (...) {
+        Destroy(alloc, dest, cur);
+        throw;
+    }
+    return cur;
+}
+
+template <typename Alloc, typename Type>
+SIMPLE_VECTOR_CONSTEXPR Type* UninitializedMove(Alloc& alloc, Type* first, Type* last, Type* dest) {
+    if constexpr (kCopiesBytes<Alloc, Type*, Type>) {
+        // перемещение тривиально копируемого элемента - то же копирование
+        return UninitializedCopy(alloc, first, last, dest);
+    } else {
+        return UninitializedCopy(alloc, std::make_move_iterator(first), std::make_move_iterator(last), dest);
+    }
+}
+
+// std::move_if_noexcept перемещает элементы Type, а не копирует их
+template <typename Type>
+inline constexpr bool kMoveIfNoexceptMoves = std::is_nothrow_move_constructible_v<Type>
+                                             || !std::is_copy_constructible_v<Type>;
+
+// После std::move_if_noexcept исходный элемент может стать перемещённым (не просто копией)
+template <typename Type>
+inline constexpr bool kMoveIfNoexceptAltersSource = kMoveIfNoexceptMoves<Type> && !std::is_trivially_copyable_v<Type>;
+
+// Перемещает, если конструктор перемещения не бросает исключений, иначе копирует.
+// Так при исключении исходный диапазон остаётся нетронутым
+template <typename Alloc, typename Type>
+SIMPLE_VECTOR_CONSTEXPR Type* UninitializedMoveIfNoexcept(Alloc& alloc, Type* first, Type* last, Type* dest) {
+    if constexpr (!kMoveIfNoexceptMoves<Type>) {
+        return UninitializedCopy(alloc, first, last, dest);
+    } else {
+        return UninitializedMove(alloc, first, last, dest);
+    }
+}
+
+// Побайтово переносит [first, last) в dest; диапазоны могут перекрываться
+template <typename Type>
+void RelocateBytes(Type* first, Type* last, Type* dest) noexcept {
+    if(first != last){
+#if defined(__GNUC__) && !defined(__clang__)
+        // После встраивания GCC рассматривает невозможные ветви (вставка за конец,
+        // перенос из пустого буфера) и предупреждает о границах memmove
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#pragma GCC diagnostic ignored "-Wnonnull"
+#pragma GCC diagnostic ignored "-Wstringop-overflow"
+#endif
+        std::memmove(static_cast<void*>(dest), static_cast<const void*>(first),
+                     static_cast<size_t>(last - first) * sizeof(Type));
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+    }
+}
+
+// Переносит [first, pos) в dest, а [pos, last) - в dest + (pos - first) + gap,
+// оставляя между ними gap неинициализированных ячеек. Исходные объекты разрушаются.
+// Если перенос бросает исключение, исходный диапазон не изменяется
+template <typename Alloc, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void RelocateWithGap(Alloc& alloc, Type* first, Type* pos, Type* last, Type* dest, size_t gap) {
+    Type* dest_tail = dest + (pos - first) + gap;
+    if(kIsTriviallyRelocatable<Type> && !IsConstantEvaluated()){
+        RelocateBytes(first, pos, dest);
+        RelocateBytes(pos, last, dest_tail);
+    } else {
+        UninitializedMoveIfNoexcept(alloc, first, pos, dest);
+        try {
+            UninitializedMoveIfNoexcept(alloc, pos, last, dest_tail);
+        } catch (...) {
+            Destroy(alloc, dest, dest + (pos - first));
+            throw;
+        }
+        Destroy(alloc, first, last);
+    }
+}
+
+template <typename Alloc, typename Type>
+SIMPLE_VECTOR_CONSTEXPR void Relocate(Alloc& alloc, Type* first, Type* last, Type* dest) {
+    RelocateWithGap(alloc, first, last, last, dest, 0);
+}
+
+} // namespace detail
@@ -0,0 +1,516 @@
+﻿#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "flat_map.h"
+#include "simple_vector.h"
+
+// Сравнение SimpleVector с std::vector на основных операциях
+// и FlatMap с std::map на поиске по ключу.
+// Параметры командной строки:
+//   --max-size=N   наибольший размер вектора (по умолчанию 1000000, до 100000000)
+//   --max-bytes=N  пропускать размеры, при которых вектор занимает больше N байт (1 ГиБ)
+//   --min-time=S   минимальное время замера одного случая в секундах (0.1)
+//   --filter=STR   запускать только случаи, в имени которых есть STR
+//   --json=PATH    записать результаты в JSON (по умолчанию в stdout)
+// Таблица с отношением времени к стандартному контейнеру печатается в stderr
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    size_t max_size = 1000000;
+    size_t max_bytes = size_t{1} << 30;
+    double min_time = 0.1;
+    std::string filter;
+    std::string json_path;
+};
+
+struct Result {
+    std::string name;
+    std::string container;
+    uint64_t iterations = 0;
+    double ns_per_op = 0;
+};
+
+// Не даёт компилятору выбросить вычисление value
+template <typename Type>
+void DoNotOptimize(const Type& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Крупный тривиально копируемый элемент
+struct LargePod {
+    std::array<uint64_t, 16> data;
+
+    bool operator==(const LargePod& other) const {
+        return data == other.data;
+    }
+
+    bool operator<(const LargePod& other) const {
+        return data < other.data;
+    }
+};
+
+// Перемещаемый, но не копируемый элемент, как X в main.cpp
+class MoveOnly {
+public:
+    explicit MoveOnly(size_t value = 5)
+        :value_(value)
+    {
+    }
+
+    MoveOnly(const MoveOnly&) = delete;
+    MoveOnly& operator=(const MoveOnly&) = delete;
+
+    MoveOnly(MoveOnly&& other)
+        :value_(std::exchange(other.value_, 0))
+    {
+    }
+
+    MoveOnly& operator=(MoveOnly&& other) {
+        value_ = std::exchange(other.value_, 0);
+        return *this;
+    }
+
+    size_t GetValue() const {
+        return value_;
+    }
+
+private:
+    size_t value_;
+};
+
+template <typename Type>
+Type MakeValue(size_t index) {
+    if constexpr (std::is_same_v<Type, LargePod>) {
+        LargePod value{};
+        value.data.fill(index);
+        return value;
+    } else {
+        return Type(index);
+    }
+}
+
+template <typename Type>
+const char* TypeName() {
+    if constexpr (std::is_same_v<Type, int>) {
+        return "int";
+    } else if constexpr (std::is_same_v<Type, LargePod>) {
+        return "large_pod";
+    } else {
+        return "move_only";
+    }
+}
+
+// Единый интерфейс к двум контейнерам
+template <typename Type>
+struct StdOps {
+    using Vector = std::vector<Type>;
+    static constexpr const char* kName = "std::vector";
+
+    static size_t GetSize(const Vector& v) {
+        return v.size();
+    }
+
+    static void PushBack(Vector& v, Type&& value) {
+        v.push_back(std::move(value));
+    }
+
+    static void Reserve(Vector& v, size_t capacity) {
+        v.reserve(capacity);
+    }
+
+    static void InsertAt(Vector& v, size_t index, Type&& value) {
+        v.insert(v.begin() + index, std::move(value));
+    }
+
+    static void EraseAt(Vector& v, size_t index) {
+        v.erase(v.begin() + index);
+    }
+
+    static void Resize(Vector& v, size_t size) {
+        v.resize(size);
+    }
+};
+
+template <typename Type>
+struct SimpleOps {
+    using Vector = SimpleVector<Type>;
+    static constexpr const char* kName = "SimpleVector";
+
+    static size_t GetSize(const Vector& v) {
+        return v.GetSize();
+    }
+
+    static void PushBack(Vector& v, Type&& value) {
+        v.PushBack(std::move(value));
+    }
+
+    static void Reserve(Vector& v, size_t capacity) {
+        v.Reserve(capacity);
+    }
+
+    static void InsertAt(Vector& v, size_t index, Type&& value) {
+        v.Insert(v.begin() + index, std::move(value));
+    }
+
+    static void EraseAt(Vector& v, size_t index) {
+        v.Erase(v.begin() + index);
+    }
+
+    static void Resize(Vector& v, size_t size) {
+        v.Resize(size);
+    }
+};
+
+class Harness {
+public:
+    explicit Harness(Options options)
+        :options_(std::move(options))
+    {
+    }
+
+    bool Selected(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    // Повторяет body, пока не наберётся min_time; body выполняет ops операций
+    template <typename Body>
+    void Measure(const std::string& name, const char* container, size_t ops, Body body) {
+        body();
+        uint64_t iterations = 0;
+        const Clock::time_point start = Clock::now();
+        Clock::duration elapsed{};
+        do {
+            body();
+            ++iterations;
+            elapsed = Clock::now() - start;
+        } while(elapsed < MinTime());
+        Record(name, container, iterations, elapsed, ops);
+    }
+
+    // То же, но setup() готовит состояние для каждого повтора и в замер не входит.
+    // Если setup много дороже body, замер ограничивается и общим временем
+    template <typename Setup, typename Body>
+    void MeasureWithSetup(const std::string& name, const char* container, size_t ops, Setup setup, Body body) {
+        uint64_t iterations = 0;
+        Clock::duration elapsed{};
+        const Clock::time_point wall_start = Clock::now();
+        do {
+            auto state = setup();
+            const Clock::time_point start = Clock::now();
+            body(state);
+            elapsed += Clock::now() - start;
+            ++iterations;
+        } while(elapsed < MinTime() && Clock::now() - wall_start < MinTime() * 10);
+        Record(name, container, iterations, elapsed, ops);
+    }
+
+    const Options& GetOptions() const {
+        return options_;
+    }
+
+    const std::vector<Result>& GetResults() const {
+        return results_;
+    }
+
+private:
+    Clock::duration MinTime() const {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options_.min_time));
+    }
+
+    void Record(const std::string& name, const char* container, uint64_t iterations,
+                Clock::duration elapsed, size_t ops) {
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        results_.push_back({name, container, iterations, ns / static_cast<double>(iterations * std::max<size_t>(ops, 1))});
+    }
+
+    Options options_;
+    std::vector<Result> results_;
+};
+
+template <typename Ops, typename Type>
+void RunCases(Harness& harness, size_t size) {
+    using Vector = typename Ops::Vector;
+    const std::string suffix = std::string("/") + TypeName<Type>() + "/" + std::to_string(size);
+    // Вставка и удаление в середине квадратичны: замеряем ограниченное число операций
+    const size_t middle_ops = std::min<size_t>(size, 64);
+
+    auto make_vector = [size] {
+        Vector v;
+        Ops::Reserve(v, size);
+        for(size_t i = 0; i < size; ++i){
+            Ops::PushBack(v, MakeValue<Type>(i));
+        }
+        return v;
+    };
+
+    if(harness.Selected("push_back" + suffix)){
+        harness.Measure("push_back" + suffix, Ops::kName, size, [size] {
+            Vector v;
+            for(size_t i = 0; i < size; ++i){
+                Ops::PushBack(v, MakeValue<Type>(i));
+            }
+            DoNotOptimize(v);
+        });
+    }
+    if(harness.Selected("push_back_reserved" + suffix)){
+        harness.Measure("push_back_reserved" + suffix, Ops::kName, size, [size] {
+            Vector v;
+            Ops::Reserve(v, size);
+            for(size_t i = 0; i < size; ++i){
+                Ops::PushBack(v, MakeValue<Type>(i));
+            }
+            DoNotOptimize(v);
+        });
+    }
+    if(harness.Selected("insert_middle" + suffix)){
+        harness.MeasureWithSetup("insert_middle" + suffix, Ops::kName, middle_ops, make_vector, [middle_ops](Vector& v) {
+            for(size_t i = 0; i < middle_ops; ++i){
+                Ops::InsertAt(v, Ops::GetSize(v) / 2, MakeValue<Type>(i));
+            }
+            DoNotOptimize(v);
+        });
+    }
+    if(harness.Selected("erase_middle" + suffix)){
+        harness.MeasureWithSetup("erase_middle" + suffix, Ops::kName, middle_ops, make_vector, [middle_ops](Vector& v) {
+            for(size_t i = 0; i < middle_ops; ++i){
+                Ops::EraseAt(v, Ops::GetSize(v) / 2);
+            }
+            DoNotOptimize(v);
+        });
+    }
+    if(harness.Selected("resize" + suffix)){
+        harness.Measure("resize" + suffix, Ops::kName, size, [size] {
+            Vector v;
+            Ops::Resize(v, size);
+            DoNotOptimize(v);
+        });
+    }
+    if(harness.Selected("move_construct" + suffix)){
+        harness.MeasureWithSetup("move_construct" + suffix, Ops::kName, 1, make_vector, [](Vector& v) {
+            Vector moved(std::move(v));
+            DoNotOptimize(moved);
+        });
+    }
+    if constexpr (std::is_copy_constructible_v<Type>) {
+        const Vector source = make_vector();
+        if(harness.Selected("copy_construct" + suffix)){
+            harness.Measure("copy_construct" + suffix, Ops::kName, size, [&source] {
+                Vector copy(source);
+                DoNotOptimize(copy);
+            });
+        }
+        Vector other = make_vector();
+        if(harness.Selected("compare_equal" + suffix)){
+            harness.Measure("compare_equal" + suffix, Ops::kName, size, [&source, &other] {
+                DoNotOptimize(source == other);
+            });
+        }
+        if(harness.Selected("compare_less" + suffix)){
+            harness.Measure("compare_less" + suffix, Ops::kName, size, [&source, &other] {
+                DoNotOptimize(source < other);
+            });
+        }
+    }
+}
+
+// Размеры от 8 до 10^8
+const std::vector<size_t>& Sizes() {
+    static const std::vector<size_t> sizes{8, 64, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+    return sizes;
+}
+
+template <typename Type>
+void RunType(Harness& harness) {
+    for(size_t size : Sizes()){
+        if(size > harness.GetOptions().max_size || size * sizeof(Type) > harness.GetOptions().max_bytes){
+            break;
+        }
+        RunCases<StdOps<Type>, Type>(harness, size);
+        RunCases<SimpleOps<Type>, Type>(harness, size);
+    }
+}
+
+// Поиск size случайных существующих ключей в словаре из size элементов
+template <typename Map, typename Insert, typename Contains>
+void MeasureLookup(Harness& harness, const std::string& name, const char* container, size_t size,
+                   Insert insert, Contains contains) {
+    std::mt19937_64 gen(size);
+    std::vector<uint64_t> keys(size);
+    for(uint64_t& key : keys){
+        key = gen();
+    }
+    Map map;
+    insert(map, keys);
+    std::shuffle(keys.begin(), keys.end(), gen);
+    harness.Measure(name, container, size, [&map, &keys, contains] {
+        size_t found = 0;
+        for(uint64_t key : keys){
+            found += contains(map, key) ? 1 : 0;
+        }
+        DoNotOptimize(found);
+    });
+}
+
+void RunLookup(Harness& harness) {
+    for(size_t size : Sizes()){
+        if(size > harness.GetOptions().max_size || size * 64 > harness.GetOptions().max_bytes){
+            break;
+        }
+        const std::string name = "lookup/uint64/" + std::to_string(size);
+        if(!harness.Selected(name)){
+            continue;
+        }
+        MeasureLookup<std::map<uint64_t, uint64_t>>(harness, name, "std::map", size,
+            [](auto& map, const std::vector<uint64_t>& keys) {
+                for(uint64_t key : keys){
+                    map.emplace(key, key);
+                }
+            },
+            [](const auto& map, uint64_t key) {
+                return map.find(key) != map.end();
+            });
+        auto bulk_insert = [](auto& map, const std::vector<uint64_t>& keys) {
+            std::vector<std::pair<uint64_t, uint64_t>> pairs;
+            for(uint64_t key : keys){
+                pairs.emplace_back(key, key);
+            }
+            map.InsertBulk(pairs.begin(), pairs.end());
+        };
+        auto contains = [](const auto& map, uint64_t key) {
+            return map.Contains(key);
+        };
+        MeasureLookup<FlatMap<uint64_t, uint64_t>>(harness, name, "FlatMap", size, bulk_insert, contains);
+        MeasureLookup<FlatMap<uint64_t, uint64_t, std::less<uint64_t>, BranchlessSearch>>(
+            harness, name, "FlatMap/branchless", size, bulk_insert, contains);
+    }
+}
+
+std::string EscapeJson(const std::string& text) {
+    std::string escaped;
+    for(char c : text){
+        if(c == '"' || c == '\\'){
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Стандартный контейнер, с которым сравнивается случай, замеряется первым
+const Result* BaselineFor(const std::vector<Result>& results, const Result& result) {
+    for(const Result& other : results){
+        if(other.name == result.name){
+            return &other;
+        }
+    }
+    return nullptr;
+}
+
+double RatioToBaseline(const std::vector<Result>& results, const Result& result) {
+    const Result* baseline = BaselineFor(results, result);
+    return baseline != nullptr && baseline->ns_per_op > 0 ? result.ns_per_op / baseline->ns_per_op : 0;
+}
+
+void WriteJson(std::ostream& out, const std::vector<Result>& results) {
+    out << "{\n  \"context\": {\"num_cpus\": " << std::thread::hardware_concurrency()
+        << ", \"time_unit\": \"ns\"},\n  \"benchmarks\": [";
+    for(size_t i = 0; i < results.size(); ++i){
+        const Result& result = results[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "    {\"name\": \"" << EscapeJson(result.container + "/" + result.name) << "\""
+            << ", \"container\": \"" << EscapeJson(result.container) << "\""
+            << ", \"case\": \"" << EscapeJson(result.name) << "\""
+            << ", \"iterations\": " << result.iterations
+            << ", \"real_time\": " << result.ns_per_op
+            << ", \"ratio_to_std\": " << RatioToBaseline(results, result) << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+void PrintTable(std::ostream& out, const std::vector<Result>& results) {
+    for(const Result& result : results){
+        const Result* baseline = BaselineFor(results, result);
+        if(baseline == &result){
+            continue;
+        }
+        out << result.name << ": " << result.container << ' ' << result.ns_per_op << " ns/op, "
+            << baseline->container << ' ' << baseline->ns_per_op << " ns/op, ratio "
+            << RatioToBaseline(results, result) << '\n';
+    }
+}
+
+Options ParseOptions(int argc, char** argv) {
+    Options options;
+    for(int i = 1; i < argc; ++i){
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+        if(key == "--max-size"){
+            options.max_size = std::stoull(value);
+        } else if(key == "--max-bytes"){
+            options.max_bytes = std::stoull(value);
+        } else if(key == "--min-time"){
+            options.min_time = std::stod(value);
+        } else if(key == "--filter"){
+            options.filter = value;
+        } else if(key == "--json"){
+            options.json_path = value;
+        } else {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = ParseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    Harness harness(options);
+    RunType<int>(harness);
+    RunType<LargePod>(harness);
+    RunType<MoveOnly>(harness);
+    RunLookup(harness);
+
+    PrintTable(std::cerr, harness.GetResults());
+    if(options.json_path.empty()){
+        WriteJson(std::cout, harness.GetResults());
+    } else {
+        std::ofstream out(options.json_path);
+        WriteJson(out, harness.GetResults());
+        if(!out){
+            std::cerr << "cannot write " << options.json_path << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
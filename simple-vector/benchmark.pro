@@ -0,0 +1,23 @@
+TEMPLATE = app
+CONFIG += console c++17 release
+CONFIG -= app_bundle
+CONFIG -= qt
+
+QMAKE_CXXFLAGS_RELEASE += -O2
+
+LIBS += -pthread
+
+SOURCES += \
+        benchmark.cpp
+
+HEADERS += \
+  array_ptr.h \
+  compact_kernels.h \
+  compare_kernels.h \
+  flat_map.h \
+  flat_search.h \
+  growth_policy.h \
+  parallel.h \
+  simple_vector.h \
+  simple_vector_view.h \
+  stats_policy.h
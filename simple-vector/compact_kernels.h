@@ -0,0 +1,101 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "compare_kernels.h"
+#include "constexpr_support.h"
+
+// Ядра уплотнения для EraseIf по арифметическим элементам.
+// Скалярное ядро не ветвится, но out зависит от предыдущей итерации, поэтому
+// компилятор его не векторизует. Ядро AVX2 (выбирается во время выполнения) вычисляет
+// предикат для блока из 32 байт в битовую маску и переставляет оставшиеся элементы
+// в начало блока одной инструкцией vpermd по таблице перестановок
+namespace detail {
+
+// Уплотнение без ветвлений: каждый элемент записывается на место out,
+// а out сдвигается, только если элемент остаётся
+template <typename Type, typename Predicate>
+SIMPLE_VECTOR_CONSTEXPR Type* RemoveIfBranchless(Type* first, Type* last, Type* out, Predicate& pred) {
+    for(; first != last; ++first){
+        const Type value = *first;
+        *out = value;
+        out += !pred(value);
+    }
+    return out;
+}
+
+#ifdef SIMPLE_VECTOR_X86_KERNELS
+
+// Для каждой маски оставшихся элементов блока из kLanes элементов - индексы
+// 32-битных слов vpermd, переносящие эти элементы в начало блока
+template <size_t kLanes>
+constexpr std::array<std::array<uint32_t, 8>, (size_t{1} << kLanes)> MakeCompactTable() {
+    constexpr size_t kWords = 8 / kLanes;
+    std::array<std::array<uint32_t, 8>, (size_t{1} << kLanes)> table{};
+    for(size_t mask = 0; mask < table.size(); ++mask){
+        size_t out = 0;
+        for(size_t lane = 0; lane < kLanes; ++lane){
+            if(mask & (size_t{1} << lane)){
+                for(size_t word = 0; word < kWords; ++word){
+                    table[mask][out * kWords + word] = static_cast<uint32_t>(lane * kWords + word);
+                }
+                ++out;
+            }
+        }
+    }
+    return table;
+}
+
+template <size_t kLanes>
+inline constexpr auto kCompactTable = MakeCompactTable<kLanes>();
+
+// Элементы по 4 и 8 байт. Блок записывается в out целиком: out не правее начала блока,
+// а лишние слова после оставшихся элементов перезаписываются следующими блоками или хвостом
+template <typename Type, typename Predicate>
+__attribute__((target("avx2")))
+Type* RemoveIfAvx2(Type* first, Type* last, Predicate& pred) {
+    static_assert(sizeof(Type) == 4 || sizeof(Type) == 8);
+    constexpr size_t kLanes = 32 / sizeof(Type);
+    Type* out = first;
+    for(; static_cast<size_t>(last - first) >= kLanes; first += kLanes){
+        unsigned keep = 0;
+        for(size_t lane = 0; lane < kLanes; ++lane){
+            keep |= static_cast<unsigned>(!pred(first[lane])) << lane;
+        }
+        const __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+        const __m256i permutation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(kCompactTable<kLanes>[keep].data()));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permutevar8x32_epi32(values, permutation));
+        out += __builtin_popcount(keep);
+    }
+    return RemoveIfBranchless(first, last, out, pred);
+}
+
+inline bool CpuHasAvx2() noexcept {
+    static const bool has_avx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return has_avx2;
+}
+
+#endif
+
+// Удаляет элементы, для которых pred истинен, сохраняя порядок остальных.
+// pred вызывается по одному разу для каждого элемента, по порядку
+template <typename Type, typename Predicate>
+SIMPLE_VECTOR_CONSTEXPR Type* RemoveIfArithmetic(Type* first, Type* last, Predicate& pred) {
+    static_assert(std::is_arithmetic_v<Type>);
+#ifdef SIMPLE_VECTOR_X86_KERNELS
+    if constexpr (sizeof(Type) == 4 || sizeof(Type) == 8) {
+        if(!IsConstantEvaluated() && CpuHasAvx2()){
+            return RemoveIfAvx2(first, last, pred);
+        }
+    }
+#endif
+    return RemoveIfBranchless(first, last, first, pred);
+}
+
+} // namespace detail
@@ -0,0 +1,147 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "constexpr_support.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMPLE_VECTOR_X86_KERNELS 1
+#endif
+
+// Ядра сравнения диапазонов для операторов ==, < и остальных.
+// Для типов, равенство которых совпадает с равенством байтов (целые, перечисления, указатели),
+// равенство проверяется через memcmp, а первое различие ищется векторно (SSE2/AVX2
+// с выбором реализации во время выполнения). Остальные типы сравниваются поэлементно
+namespace detail {
+
+// Равные значения имеют одинаковое представление в памяти и наоборот.
+// Числа с плавающей точкой не подходят: -0.0 == 0.0, а NaN != NaN
+template <typename Type>
+inline constexpr bool kIsBitwiseComparable = std::is_integral_v<Type> || std::is_enum_v<Type> || std::is_pointer_v<Type>;
+
+// Побайтовый порядок memcmp совпадает с порядком значений
+template <typename Type>
+inline constexpr bool kIsBytewiseOrdered = std::is_same_v<Type, unsigned char> || std::is_same_v<Type, std::byte>
+                                           || std::is_same_v<Type, bool>
+                                           || (std::is_same_v<Type, char> && std::is_unsigned_v<char>);
+
+inline size_t MismatchBytesScalar(const unsigned char* lhs, const unsigned char* rhs, size_t size) noexcept {
+    size_t i = 0;
+    // сравниваем по 8 байт, пока не встретится отличие
+    for(; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)){
+        uint64_t a;
+        uint64_t b;
+        std::memcpy(&a, lhs + i, sizeof(a));
+        std::memcpy(&b, rhs + i, sizeof(b));
+        if(a != b){
+            break;
+        }
+    }
+    for(; i < size && lhs[i] == rhs[i]; ++i){
+    }
+    return i;
+}
+
+#ifdef SIMPLE_VECTOR_X86_KERNELS
+
+__attribute__((target("sse2")))
+inline size_t MismatchBytesSse2(const unsigned char* lhs, const unsigned char* rhs, size_t size) noexcept {
+    size_t i = 0;
+    for(; i + 16 <= size; i += 16){
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i));
+        const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+        if(mask != 0xFFFFu){
+            return i + static_cast<size_t>(__builtin_ctz(~mask));
+        }
+    }
+    return i + MismatchBytesScalar(lhs + i, rhs + i, size - i);
+}
+
+__attribute__((target("avx2")))
+inline size_t MismatchBytesAvx2(const unsigned char* lhs, const unsigned char* rhs, size_t size) noexcept {
+    size_t i = 0;
+    for(; i + 32 <= size; i += 32){
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+        if(mask != 0xFFFFFFFFu){
+            return i + static_cast<size_t>(__builtin_ctz(~mask));
+        }
+    }
+    return i + MismatchBytesSse2(lhs + i, rhs + i, size - i);
+}
+
+using MismatchBytesFn = size_t (*)(const unsigned char*, const unsigned char*, size_t) noexcept;
+
+// Реализация выбирается один раз по возможностям процессора
+inline MismatchBytesFn SelectMismatchBytes() noexcept {
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+        return &MismatchBytesAvx2;
+    }
+    if(__builtin_cpu_supports("sse2")){
+        return &MismatchBytesSse2;
+    }
+    return &MismatchBytesScalar;
+}
+
+#endif
+
+// Возвращает индекс первого различающегося байта или size
+inline size_t MismatchBytes(const unsigned char* lhs, const unsigned char* rhs, size_t size) noexcept {
+#ifdef SIMPLE_VECTOR_X86_KERNELS
+    static const MismatchBytesFn kernel = SelectMismatchBytes();
+    return kernel(lhs, rhs, size);
+#else
+    return MismatchBytesScalar(lhs, rhs, size);
+#endif
+}
+
+// Возвращает индекс первого различающегося элемента или size
+template <typename Type>
+size_t Mismatch(const Type* lhs, const Type* rhs, size_t size) noexcept {
+    static_assert(kIsBitwiseComparable<Type>);
+    const size_t byte = MismatchBytes(reinterpret_cast<const unsigned char*>(lhs),
+                                      reinterpret_cast<const unsigned char*>(rhs), size * sizeof(Type));
+    return byte / sizeof(Type);
+}
+
+template <typename Type>
+SIMPLE_VECTOR_CONSTEXPR bool RangeEqual(const Type* lhs, size_t lhs_size, const Type* rhs, size_t rhs_size) {
+    if(lhs_size != rhs_size){
+        return false;
+    }
+    if(IsConstantEvaluated()){
+        return std::equal(lhs, lhs + lhs_size, rhs);
+    }
+    if constexpr (kIsBitwiseComparable<Type>) {
+        return lhs_size == 0 || std::memcmp(lhs, rhs, lhs_size * sizeof(Type)) == 0;
+    } else {
+        return std::equal(lhs, lhs + lhs_size, rhs);
+    }
+}
+
+template <typename Type>
+SIMPLE_VECTOR_CONSTEXPR bool RangeLess(const Type* lhs, size_t lhs_size, const Type* rhs, size_t rhs_size) {
+    if(IsConstantEvaluated()){
+        return std::lexicographical_compare(lhs, lhs + lhs_size, rhs, rhs + rhs_size);
+    }
+    const size_t common = std::min(lhs_size, rhs_size);
+    if constexpr (kIsBytewiseOrdered<Type>) {
+        const int result = common == 0 ? 0 : std::memcmp(lhs, rhs, common);
+        return result != 0 ? result < 0 : lhs_size < rhs_size;
+    } else if constexpr (kIsBitwiseComparable<Type>) {
+        const size_t index = Mismatch(lhs, rhs, common);
+        return index != common ? lhs[index] < rhs[index] : lhs_size < rhs_size;
+    } else {
+        return std::lexicographical_compare(lhs, lhs + lhs_size, rhs, rhs + rhs_size);
+    }
+}
+
+} // namespace detail
@@ -0,0 +1,293 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "array_ptr.h"
+#include "simple_vector.h"
+
+// Вектор для одновременного добавления из нескольких потоков.
+// Память состоит из сегментов: сегмент k вмещает kFirstSegmentSize << k элементов
+// и после выделения никогда не перемещается, поэтому ссылки и указатели на элементы
+// остаются действительными до Clear или разрушения вектора.
+// PushBack/GrowBy сначала выделяют нужные сегменты, затем резервируют номера ячеек
+// атомарным compare_exchange, конструируют элементы и публикуют их по порядку номеров:
+// писатель ждёт, пока опубликуют ячейки с меньшими номерами.
+//
+// GetSize() - число опубликованных ячеек; читатель может обходить [0, GetSize())
+// из любого потока, а operator[] не блокируется и никого не ждёт.
+// Если выделение сегмента бросает исключение, ячейки не резервируются.
+// Если бросает конструктор элемента, исключение передаётся вызывающему, а ячейки
+// всё равно публикуются, но остаются пустыми: HasElement для них возвращает false
+template <typename Type, typename Alloc = std::allocator<Type>>
+class ConcurrentSimpleVector {
+public:
+    static constexpr size_t kFirstSegmentSize = 16;
+
+    ConcurrentSimpleVector() = default;
+
+    explicit ConcurrentSimpleVector(const Alloc& alloc) noexcept
+        :alloc_(alloc)
+    {
+    }
+
+    ConcurrentSimpleVector(const ConcurrentSimpleVector&) = delete;
+    ConcurrentSimpleVector& operator=(const ConcurrentSimpleVector&) = delete;
+
+    ~ConcurrentSimpleVector() {
+        Clear();
+        for(size_t segment = 0; segment < kSegmentCount; ++segment){
+            if(Type* data = segments_[segment].load(std::memory_order_relaxed)){
+                AllocTraits::deallocate(alloc_, data, SegmentSize(segment));
+            }
+        }
+    }
+
+    // Добавляет элемент и возвращает его номер
+    size_t PushBack(const Type& item) {
+        return GrowBy(1, item);
+    }
+
+    size_t PushBack(Type&& item) {
+        const size_t index = ReserveSlots(1);
+        ConstructSlots(index, 1, [this, &item](Type* slot) {
+            AllocTraits::construct(alloc_, slot, std::move(item));
+        });
+        return index;
+    }
+
+    // Конструирует элемент в конце вектора из args и возвращает ссылку на него
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        const size_t index = ReserveSlots(1);
+        ConstructSlots(index, 1, [&](Type* slot) {
+            AllocTraits::construct(alloc_, slot, std::forward<Args>(args)...);
+        });
+        return (*this)[index];
+    }
+
+    // Добавляет count копий value одним резервированием и возвращает номер первой
+    size_t GrowBy(size_t count, const Type& value = Type()) {
+        const size_t first = ReserveSlots(count);
+        ConstructSlots(first, count, [this, &value](Type* slot) {
+            AllocTraits::construct(alloc_, slot, value);
+        });
+        return first;
+    }
+
+    // Заранее выделяет сегменты под capacity элементов, чтобы PushBack не тратил на это время
+    void Reserve(size_t capacity) {
+        if(capacity == 0){
+            return;
+        }
+        const size_t last_segment = SegmentOf(capacity - 1);
+        for(size_t segment = 0; segment <= last_segment; ++segment){
+            EnsureSegment(segment);
+        }
+    }
+
+    // Число опубликованных ячеек: все ячейки с меньшими номерами сконструированы
+    // (или пусты после исключения) и видны вызывающему потоку
+    size_t GetSize() const noexcept {
+        return committed_.load(std::memory_order_acquire);
+    }
+
+    // Опубликована ли ячейка index с элементом, а не пустой после исключения конструктора
+    bool HasElement(size_t index) const {
+        return index < GetSize() && !IsEmptySlot(index);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Число элементов, помещающихся в уже выделенные сегменты
+    size_t GetCapacity() const noexcept {
+        size_t segment = 0;
+        while(segment < kSegmentCount && segments_[segment].load(std::memory_order_acquire) != nullptr){
+            ++segment;
+        }
+        return SegmentStart(segment);
+    }
+
+    // Возвращает ссылку на элемент с индексом index. Не блокируется и не ждёт писателей.
+    // Ячейка должна быть опубликована: index < GetSize() или номер получен от PushBack
+    Type& operator[](size_t index) noexcept {
+        assert(index < reserved_.load(std::memory_order_relaxed));
+        const size_t segment = SegmentOf(index);
+        return segments_[segment].load(std::memory_order_acquire)[index - SegmentStart(segment)];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentSimpleVector&>(*this)[index];
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if(index >= GetSize()){
+            throw std::out_of_range("index out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        return const_cast<ConcurrentSimpleVector&>(*this).At(index);
+    }
+
+    // Разрушает все элементы, оставляя сегменты выделенными.
+    // Нельзя вызывать одновременно с другими операциями
+    void Clear() noexcept {
+        const size_t size = committed_.load(std::memory_order_acquire);
+        if(has_empty_slots_.load(std::memory_order_relaxed)){
+            for(size_t index = 0; index < size; ++index){
+                if(!IsEmptySlot(index)){
+                    AllocTraits::destroy(alloc_, &(*this)[index]);
+                }
+            }
+        } else {
+            for(size_t index = 0; index < size;){
+                const size_t segment = SegmentOf(index);
+                Type* data = segments_[segment].load(std::memory_order_relaxed);
+                const size_t last = std::min(size, SegmentStart(segment + 1));
+                detail::Destroy(alloc_, data + (index - SegmentStart(segment)), data + (last - SegmentStart(segment)));
+                index = last;
+            }
+        }
+        empty_slots_.Clear();
+        has_empty_slots_.store(false, std::memory_order_relaxed);
+        reserved_.store(0, std::memory_order_relaxed);
+        committed_.store(0, std::memory_order_release);
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    // Сегменты покрывают всё пространство индексов size_t
+    static constexpr size_t kSegmentCount = sizeof(size_t) * 8 - 4;
+    static_assert(kFirstSegmentSize == 16, "kSegmentCount assumes 16-element first segment");
+
+    static constexpr size_t SegmentSize(size_t segment) noexcept {
+        return kFirstSegmentSize << segment;
+    }
+
+    // Индекс первого элемента сегмента: 16 * (2^segment - 1)
+    static constexpr size_t SegmentStart(size_t segment) noexcept {
+        return kFirstSegmentSize * ((size_t{1} << segment) - 1);
+    }
+
+    // Номер старшего единичного бита (index / 16 + 1)
+    static size_t SegmentOf(size_t index) noexcept {
+        const unsigned long long block = index / kFirstSegmentSize + 1;
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(block));
+#else
+        size_t segment = 0;
+        for(unsigned long long rest = block >> 1; rest != 0; rest >>= 1){
+            ++segment;
+        }
+        return segment;
+#endif
+    }
+
+    // Выделяет сегменты под ячейки [first, first + count) и резервирует их.
+    // Если выделение бросает исключение, вектор не меняется
+    size_t ReserveSlots(size_t count) {
+        size_t first = reserved_.load(std::memory_order_relaxed);
+        do {
+            if(count != 0){
+                const size_t last_segment = SegmentOf(first + count - 1);
+                for(size_t segment = SegmentOf(first); segment <= last_segment; ++segment){
+                    EnsureSegment(segment);
+                }
+            }
+        } while(!reserved_.compare_exchange_weak(first, first + count, std::memory_order_relaxed));
+        return first;
+    }
+
+    // Конструирует ячейки [first, first + count) через construct(slot) и публикует их.
+    // При исключении уже созданные элементы разрушаются, ячейки помечаются пустыми
+    // и публикуются, чтобы не задерживать следующих писателей
+    template <typename Construct>
+    void ConstructSlots(size_t first, size_t count, Construct construct) {
+        size_t index = first;
+        try {
+            for(; index < first + count; ++index){
+                construct(&(*this)[index]);
+            }
+        } catch (...) {
+            for(size_t done = first; done < index; ++done){
+                AllocTraits::destroy(alloc_, &(*this)[done]);
+            }
+            MarkEmpty(first, count);
+            Commit(first, count);
+            throw;
+        }
+        Commit(first, count);
+    }
+
+    // Публикует ячейки после того, как опубликованы все предыдущие
+    void Commit(size_t first, size_t count) noexcept {
+        while(committed_.load(std::memory_order_acquire) != first){
+            std::this_thread::yield();
+        }
+        committed_.store(first + count, std::memory_order_release);
+    }
+
+    void MarkEmpty(size_t first, size_t count) noexcept {
+        std::lock_guard<std::mutex> lock(empty_slots_mutex_);
+        try {
+            empty_slots_.PushBack({first, first + count});
+        } catch (...) {
+            // без памяти под запись о пустых ячейках продолжать нельзя
+            std::terminate();
+        }
+        has_empty_slots_.store(true, std::memory_order_release);
+    }
+
+    bool IsEmptySlot(size_t index) const {
+        if(!has_empty_slots_.load(std::memory_order_acquire)){
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(empty_slots_mutex_);
+        for(const auto& [first, last] : empty_slots_){
+            if(index >= first && index < last){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Возвращает сегмент, выделяя его при необходимости. Если несколько потоков
+    // выделили сегмент одновременно, остаётся первый установленный, остальные освобождают свой
+    Type* EnsureSegment(size_t segment) {
+        Type* data = segments_[segment].load(std::memory_order_acquire);
+        if(data != nullptr){
+            return data;
+        }
+        Type* fresh = AllocTraits::allocate(alloc_, SegmentSize(segment));
+        if(segments_[segment].compare_exchange_strong(data, fresh, std::memory_order_acq_rel,
+                                                      std::memory_order_acquire)){
+            return fresh;
+        }
+        AllocTraits::deallocate(alloc_, fresh, SegmentSize(segment));
+        return data;
+    }
+
+    Alloc alloc_;
+    // Выданные номера ячеек и опубликованный префикс: committed_ <= reserved_
+    std::atomic<size_t> reserved_{0};
+    std::atomic<size_t> committed_{0};
+    std::array<std::atomic<Type*>, kSegmentCount> segments_{};
+    // Диапазоны ячеек, конструктор которых бросил исключение. Бывают редко,
+    // поэтому хранятся под мьютексом; флаг избавляет читателей от блокировки
+    mutable std::mutex empty_slots_mutex_;
+    SimpleVector<std::pair<size_t, size_t>> empty_slots_;
+    std::atomic<bool> has_empty_slots_{false};
+};
@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <memory>
+#include <type_traits>
+
+// Под C++20 с выделением памяти при вычислениях во время компиляции
+// (constexpr new и constexpr std::allocator) ArrayPtr и SimpleVector помечаются constexpr:
+// таблицы можно строить при компиляции и копировать в статические массивы.
+// В остальных режимах макрос пуст и код остаётся обычным C++17
+#if defined(__cpp_constexpr_dynamic_alloc) && __cpp_constexpr_dynamic_alloc >= 201907L \
+    && defined(__cpp_lib_constexpr_dynamic_alloc)
+#define SIMPLE_VECTOR_CONSTEXPR constexpr
+#define SIMPLE_VECTOR_HAS_CONSTEXPR 1
+#else
+#define SIMPLE_VECTOR_CONSTEXPR
+#endif
+
+namespace detail {
+
+// true при вычислении во время компиляции: там недоступны memcpy, memmove,
+// memcmp и векторные ядра, и код переходит на поэлементные ветки
+constexpr bool IsConstantEvaluated() noexcept {
+#if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+} // namespace detail
@@ -0,0 +1,303 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "simple_vector.h"
+
+// SimpleVector с копированием при записи.
+// Копии разделяют один буфер со счётчиком ссылок, поэтому копирование и присваивание
+// стоят O(1) и не выделяют память. Первый изменяющий вызов у разделяемого буфера
+// (неконстантные operator[], At, begin/end, PushBack, Insert, Erase, Resize и т.д.)
+// делает собственную копию. Счётчик атомарный: копии можно отдавать другим потокам,
+// но один объект CowSimpleVector, как и SimpleVector, нельзя менять из нескольких потоков.
+// Ссылки и итераторы, полученные до копирования объекта, после него менять нельзя:
+// запись через них видна во всех копиях
+template <typename Type, typename Alloc = std::allocator<Type>, typename Growth = DoublingGrowth>
+class CowSimpleVector {
+public:
+    using Vector = SimpleVector<Type, Alloc, Growth>;
+    using Iterator = typename Vector::Iterator;
+    using ConstIterator = typename Vector::ConstIterator;
+
+    CowSimpleVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit CowSimpleVector(size_t size)
+        :buffer_(MakeBuffer(size))
+    {
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    CowSimpleVector(size_t size, const Type& value)
+        :buffer_(MakeBuffer(size, value))
+    {
+    }
+
+    // Создаёт вектор из std::initializer_list
+    CowSimpleVector(std::initializer_list<Type> init)
+        :buffer_(MakeBuffer(init))
+    {
+    }
+
+    // Забирает содержимое обычного вектора без копирования элементов
+    explicit CowSimpleVector(Vector&& vector)
+        :buffer_(MakeBuffer(std::move(vector)))
+    {
+    }
+
+    // Разделяет буфер other
+    CowSimpleVector(const CowSimpleVector& other) noexcept
+        :buffer_(other.buffer_)
+    {
+        if(buffer_ != nullptr){
+            buffer_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CowSimpleVector(CowSimpleVector&& other) noexcept
+        :buffer_(std::exchange(other.buffer_, nullptr))
+    {
+    }
+
+    ~CowSimpleVector() {
+        Release();
+    }
+
+    CowSimpleVector& operator=(const CowSimpleVector& rhs) noexcept {
+        CowSimpleVector tmp(rhs);
+        swap(tmp);
+        return *this;
+    }
+
+    CowSimpleVector& operator=(CowSimpleVector&& rhs) noexcept {
+        if(this != &rhs){
+            Release();
+            buffer_ = std::exchange(rhs.buffer_, nullptr);
+        }
+        return *this;
+    }
+
+    // Неизменяемый доступ к содержимому как к обычному вектору
+    const Vector& Get() const noexcept {
+        return buffer_ != nullptr ? buffer_->data : EmptyVector();
+    }
+
+    // Собственная копия для изменения: отделяет буфер, если он разделяемый
+    Vector& Mutable() {
+        Detach();
+        return buffer_->data;
+    }
+
+    // Число объектов, разделяющих буфер (0 у пустого вектора без буфера)
+    size_t UseCount() const noexcept {
+        return buffer_ != nullptr ? buffer_->refs.load(std::memory_order_acquire) : 0;
+    }
+
+    bool IsShared() const noexcept {
+        return UseCount() > 1;
+    }
+
+    void PushBack(const Type& item) {
+        Mutable().PushBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        Mutable().PushBack(std::move(item));
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // Позиции принимаются номерами: итераторы разделяемого буфера
+    // после отделения указывали бы в чужую память
+    Iterator Insert(size_t pos, const Type& value) {
+        Vector& vector = Mutable();
+        return vector.Insert(vector.begin() + pos, value);
+    }
+
+    Iterator Insert(size_t pos, Type&& value) {
+        Vector& vector = Mutable();
+        return vector.Insert(vector.begin() + pos, std::move(value));
+    }
+
+    void PopBack() {
+        Mutable().PopBack();
+    }
+
+    Iterator Erase(size_t pos) {
+        Vector& vector = Mutable();
+        return vector.Erase(vector.begin() + pos);
+    }
+
+    Iterator Erase(size_t first, size_t last) {
+        Vector& vector = Mutable();
+        return vector.Erase(vector.begin() + first, vector.begin() + last);
+    }
+
+    void Resize(size_t new_size) {
+        Mutable().Resize(new_size);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Mutable().Reserve(new_capacity);
+    }
+
+    // Разделяемый буфер не копируется: вектор просто отказывается от него
+    void Clear() noexcept {
+        if(IsShared()){
+            Release();
+            buffer_ = nullptr;
+        } else if(buffer_ != nullptr){
+            buffer_->data.Clear();
+        }
+    }
+
+    void swap(CowSimpleVector& other) noexcept {
+        std::swap(buffer_, other.buffer_);
+    }
+
+    size_t GetSize() const noexcept {
+        return Get().GetSize();
+    }
+
+    size_t GetCapacity() const noexcept {
+        return Get().GetCapacity();
+    }
+
+    bool IsEmpty() const noexcept {
+        return Get().IsEmpty();
+    }
+
+    // Отделяет буфер, если он разделяемый
+    Type& operator[](size_t index) {
+        return Mutable()[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        return Get()[index];
+    }
+
+    Type& At(size_t index) {
+        if(index >= GetSize()){
+            throw std::out_of_range("index out of range");
+        }
+        return Mutable()[index];
+    }
+
+    const Type& At(size_t index) const {
+        return Get().At(index);
+    }
+
+    // Неконстантные итераторы отделяют буфер
+    Iterator begin() {
+        return Mutable().begin();
+    }
+
+    Iterator end() {
+        return Mutable().end();
+    }
+
+    ConstIterator begin() const noexcept {
+        return Get().begin();
+    }
+
+    ConstIterator end() const noexcept {
+        return Get().end();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    // Разделяемый буфер: счётчик ссылок и сам вектор в одном блоке
+    struct Buffer {
+        template <typename... Args>
+        explicit Buffer(Args&&... args)
+            :data(std::forward<Args>(args)...)
+        {
+        }
+
+        std::atomic<size_t> refs{1};
+        Vector data;
+    };
+
+    template <typename... Args>
+    static Buffer* MakeBuffer(Args&&... args) {
+        return new Buffer(std::forward<Args>(args)...);
+    }
+
+    static const Vector& EmptyVector() noexcept {
+        static const Vector empty;
+        return empty;
+    }
+
+    // Последний владелец разрушает буфер; acquire-часть fetch_sub делает видимыми
+    // все записи других владельцев до их отказа от буфера
+    void Release() noexcept {
+        if(buffer_ != nullptr && buffer_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+            delete buffer_;
+        }
+    }
+
+    void Detach() {
+        if(buffer_ == nullptr){
+            buffer_ = MakeBuffer();
+        } else if(buffer_->refs.load(std::memory_order_acquire) != 1){
+            Buffer* copy = MakeBuffer(buffer_->data);
+            Release();
+            buffer_ = copy;
+        }
+    }
+
+    Buffer* buffer_ = nullptr;
+};
+
+// Векторы с общим буфером равны без сравнения элементов, если равенство элементов
+// рефлексивно (целые, перечисления, указатели). Для остальных типов, например
+// double с NaN, результат совпадает со сравнением SimpleVector
+template <typename Type, typename Alloc, typename Growth>
+inline bool operator==(const CowSimpleVector<Type, Alloc, Growth>& lhs, const CowSimpleVector<Type, Alloc, Growth>& rhs) {
+    if constexpr (detail::kIsBitwiseComparable<Type>) {
+        if(&lhs.Get() == &rhs.Get()){
+            return true;
+        }
+    }
+    return lhs.Get() == rhs.Get();
+}
+
+template <typename Type, typename Alloc, typename Growth>
+inline bool operator!=(const CowSimpleVector<Type, Alloc, Growth>& lhs, const CowSimpleVector<Type, Alloc, Growth>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, typename Alloc, typename Growth>
+inline bool operator<(const CowSimpleVector<Type, Alloc, Growth>& lhs, const CowSimpleVector<Type, Alloc, Growth>& rhs) {
+    return lhs.Get() < rhs.Get();
+}
+
+template <typename Type, typename Alloc, typename Growth>
+inline bool operator<=(const CowSimpleVector<Type, Alloc, Growth>& lhs, const CowSimpleVector<Type, Alloc, Growth>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type, typename Alloc, typename Growth>
+inline bool operator>(const CowSimpleVector<Type, Alloc, Growth>& lhs, const CowSimpleVector<Type, Alloc, Growth>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, typename Alloc, typename Growth>
+inline bool operator>=(const CowSimpleVector<Type, Alloc, Growth>& lhs, const CowSimpleVector<Type, Alloc, Growth>& rhs) {
+    return !(lhs < rhs);
+}
@@ -0,0 +1,340 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "flat_search.h"
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+// Упорядоченный словарь на двух SimpleVector: отсортированные ключи и значения
+// в том же порядке. Поиск читает только массив ключей, поэтому в кэш попадают
+// лишь ключи, а не пары целиком. Политика Search - см. flat_search.h.
+// Элемент при обходе - пара ссылок std::pair<const Key&, Value&>
+template <typename Key, typename Value, typename Compare = std::less<Key>, typename Search = BinarySearch>
+class FlatMap {
+    template <bool kConst>
+    class BasicIterator;
+
+public:
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+        :comp_(comp)
+    {
+    }
+
+    FlatMap(std::initializer_list<std::pair<Key, Value>> init, const Compare& comp = Compare())
+        :comp_(comp)
+    {
+        InsertBulk(init.begin(), init.end());
+    }
+
+    // Вставляет пару, если ключа ещё нет; существующее значение не меняется.
+    // Возвращает итератор на элемент и признак того, что вставка произошла
+    template <typename K, typename V>
+    std::pair<Iterator, bool> Insert(K&& key, V&& value) {
+        const size_t index = LowerIndex(key);
+        if(index != GetSize() && !comp_(key, keys_[index])){
+            return {begin() + index, false};
+        }
+        InsertAt(index, std::forward<K>(key), std::forward<V>(value));
+        return {begin() + index, true};
+    }
+
+    // Вставляет пару или заменяет значение существующего ключа
+    template <typename K, typename V>
+    std::pair<Iterator, bool> InsertOrAssign(K&& key, V&& value) {
+        const size_t index = LowerIndex(key);
+        if(index != GetSize() && !comp_(key, keys_[index])){
+            values_[index] = std::forward<V>(value);
+            return {begin() + index, false};
+        }
+        InsertAt(index, std::forward<K>(key), std::forward<V>(value));
+        return {begin() + index, true};
+    }
+
+    // Вставляет пары диапазона [first, last): добавление в буфер, устойчивая сортировка
+    // по ключу и слияние с существующими парами за один проход. Из повторяющихся ключей
+    // остаётся уже имевшийся в словаре, а среди новых - первый.
+    // Имеющиеся пары переносятся через std::move_if_noexcept, поэтому при исключении
+    // словарь остаётся прежним. Исключение: если ключи или значения нетривиальны
+    // и перемещаются без исключений, а во время слияния бросает comp_ или копирование
+    // другой части пары, словарь очищается.
+    // Слияние идёт в новые буферы, а не на месте: исходные пары не трогаются
+    // до успешного конца, и откатывать при исключении нечего
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void InsertBulk(InputIt first, InputIt last) {
+        SimpleVector<std::pair<Key, Value>> incoming(first, last);
+        if(incoming.IsEmpty()){
+            return;
+        }
+        std::stable_sort(incoming.begin(), incoming.end(), [this](const auto& lhs, const auto& rhs) {
+            return comp_(lhs.first, rhs.first);
+        });
+
+        const size_t capacity = GetSize() + incoming.GetSize();
+        SimpleVector<Key> keys(::Reserve(capacity));
+        SimpleVector<Value> values(::Reserve(capacity));
+        auto emit = [&](auto&& key, auto&& value) {
+            if(keys.IsEmpty() || comp_(keys[keys.GetSize() - 1], key)){
+                keys.PushBack(std::forward<decltype(key)>(key));
+                values.PushBack(std::forward<decltype(value)>(value));
+            }
+        };
+        try {
+            size_t left = 0;
+            auto right = incoming.begin();
+            while(left != GetSize() && right != incoming.end()){
+                if(comp_(right->first, keys_[left])){
+                    emit(std::move(right->first), std::move(right->second));
+                    ++right;
+                } else {
+                    emit(std::move_if_noexcept(keys_[left]), std::move_if_noexcept(values_[left]));
+                    ++left;
+                }
+            }
+            for(; left != GetSize(); ++left){
+                emit(std::move_if_noexcept(keys_[left]), std::move_if_noexcept(values_[left]));
+            }
+            for(; right != incoming.end(); ++right){
+                emit(std::move(right->first), std::move(right->second));
+            }
+        } catch (...) {
+            if(detail::kMoveIfNoexceptAltersSource<Key> || detail::kMoveIfNoexceptAltersSource<Value>){
+                Clear();
+            }
+            throw;
+        }
+        keys_ = std::move(keys);
+        values_ = std::move(values);
+    }
+
+    void InsertBulk(std::initializer_list<std::pair<Key, Value>> init) {
+        InsertBulk(init.begin(), init.end());
+    }
+
+    // Возвращает значение ключа, вставляя значение по умолчанию, если ключа нет
+    Value& operator[](const Key& key) {
+        const size_t index = LowerIndex(key);
+        if(index == GetSize() || comp_(key, keys_[index])){
+            InsertAt(index, key, Value());
+        }
+        return values_[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если ключа нет
+    Value& At(const Key& key) {
+        const size_t index = FindIndex(key);
+        if(index == GetSize()){
+            throw std::out_of_range("key not found");
+        }
+        return values_[index];
+    }
+
+    const Value& At(const Key& key) const {
+        const size_t index = FindIndex(key);
+        if(index == GetSize()){
+            throw std::out_of_range("key not found");
+        }
+        return values_[index];
+    }
+
+    Iterator Find(const Key& key) {
+        return begin() + FindIndex(key);
+    }
+
+    ConstIterator Find(const Key& key) const {
+        return begin() + FindIndex(key);
+    }
+
+    bool Contains(const Key& key) const {
+        return FindIndex(key) != GetSize();
+    }
+
+    // Удаляет ключ. Возвращает количество удалённых элементов (0 или 1)
+    size_t Erase(const Key& key) {
+        const size_t index = FindIndex(key);
+        if(index == GetSize()){
+            return 0;
+        }
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+        return 1;
+    }
+
+    Iterator LowerBound(const Key& key) {
+        return begin() + LowerIndex(key);
+    }
+
+    ConstIterator LowerBound(const Key& key) const {
+        return begin() + LowerIndex(key);
+    }
+
+    size_t GetSize() const noexcept {
+        return keys_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return keys_.IsEmpty();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+        values_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    void swap(FlatMap& other) noexcept {
+        using std::swap;
+        swap(comp_, other.comp_);
+        keys_.swap(other.keys_);
+        values_.swap(other.values_);
+    }
+
+    // Отсортированные ключи
+    SimpleVectorView<const Key> Keys() const noexcept {
+        return keys_;
+    }
+
+    // Значения в порядке ключей
+    SimpleVectorView<Value> Values() noexcept {
+        return values_;
+    }
+
+    SimpleVectorView<const Value> Values() const noexcept {
+        return values_;
+    }
+
+    Iterator begin() noexcept {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept {
+        return Iterator(this, GetSize());
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, GetSize());
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    friend bool operator==(const FlatMap& lhs, const FlatMap& rhs) {
+        return lhs.keys_ == rhs.keys_ && lhs.values_ == rhs.values_;
+    }
+
+    friend bool operator!=(const FlatMap& lhs, const FlatMap& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    // Итератор по парам; разыменование даёт пару ссылок на ключ и значение
+    template <bool kConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<kConst, const FlatMap, FlatMap>;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::pair<Key, Value>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const Key&, std::conditional_t<kConst, const Value&, Value&>>;
+        using pointer = void;
+
+        BasicIterator() noexcept = default;
+
+        reference operator*() const noexcept {
+            return reference(owner_->keys_[index_], owner_->values_[index_]);
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator tmp = *this;
+            ++index_;
+            return tmp;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            it.index_ += offset;
+            return it;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+    private:
+        friend class FlatMap;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            :owner_(owner)
+            ,index_(index)
+        {
+        }
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    size_t LowerIndex(const Key& key) const {
+        return Search::LowerBound(keys_.begin(), keys_.GetSize(), key, comp_);
+    }
+
+    // Индекс ключа или GetSize(), если его нет
+    size_t FindIndex(const Key& key) const {
+        const size_t index = LowerIndex(key);
+        return index != GetSize() && !comp_(key, keys_[index]) ? index : GetSize();
+    }
+
+    // Вставляет пару в позицию index; если вставка значения не удалась, ключ удаляется
+    template <typename K, typename V>
+    void InsertAt(size_t index, K&& key, V&& value) {
+        keys_.Insert(keys_.begin() + index, std::forward<K>(key));
+        try {
+            values_.Insert(values_.begin() + index, std::forward<V>(value));
+        } catch (...) {
+            keys_.Erase(keys_.begin() + index);
+            throw;
+        }
+    }
+
+    Compare comp_;
+    SimpleVector<Key> keys_;
+    SimpleVector<Value> values_;
+};
@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+// Политики поиска в отсортированном массиве для FlatSet и FlatMap.
+// LowerBound возвращает индекс первого элемента, не меньшего key, или size
+
+// Обычный двоичный поиск (std::lower_bound)
+struct BinarySearch {
+    template <typename Type, typename Key, typename Compare>
+    static size_t LowerBound(const Type* data, size_t size, const Key& key, const Compare& comp) {
+        return std::lower_bound(data, data + size, key, comp) - data;
+    }
+};
+
+// Двоичный поиск без ветвлений: на каждом шаге половина отбрасывается
+// условным присваиванием (cmov), так что процессору нечего предсказывать.
+// Число шагов зависит только от размера, и на больших массивах, где сравнения
+// непредсказуемы, это быстрее std::lower_bound
+struct BranchlessSearch {
+    template <typename Type, typename Key, typename Compare>
+    static size_t LowerBound(const Type* data, size_t size, const Key& key, const Compare& comp) {
+        if(size == 0){
+            return 0;
+        }
+        const Type* base = data;
+        while(size > 1){
+            const size_t half = size / 2;
+#if defined(__GNUC__) || defined(__clang__)
+            // Обе возможные середины следующего шага загружаются заранее,
+            // иначе на массивах больше кэша каждый шаг ждёт память
+            __builtin_prefetch(base + half / 2);
+            __builtin_prefetch(base + half + half / 2);
+#endif
+            base += static_cast<size_t>(comp(base[half - 1], key)) * half;
+            size -= half;
+        }
+        return (base - data) + (comp(*base, key) ? 1 : 0);
+    }
+};
@@ -0,0 +1,248 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+#include "flat_search.h"
+#include "simple_vector.h"
+
+namespace detail {
+
+// Объединяет отсортированные [first, mid) и [mid, last) в out за один проход,
+// пропуская элементы, эквивалентные уже записанному. При равенстве побеждает
+// элемент из первой половины, внутри половины - более ранний.
+// Элементы передаются через std::move_if_noexcept: если перемещение может бросить
+// исключение, они копируются, и при исключении исходный диапазон не изменяется
+template <typename Type, typename Compare, typename Out>
+void MergeUnique(Type* first, Type* mid, Type* last, const Compare& comp, Out out) {
+    Type* left = first;
+    Type* right = mid;
+    const Type* written = nullptr;
+    auto emit = [&](Type*& from) {
+        if(written == nullptr || comp(*written, *from)){
+            written = &out(std::move_if_noexcept(*from));
+        }
+        ++from;
+    };
+    while(left != mid && right != last){
+        if(comp(*right, *left)){
+            emit(right);
+        } else {
+            emit(left);
+        }
+    }
+    while(left != mid){
+        emit(left);
+    }
+    while(right != last){
+        emit(right);
+    }
+}
+
+} // namespace detail
+
+// Упорядоченное множество в непрерывном SimpleVector.
+// Поиск двоичный (политика Search, см. flat_search.h), обход - линейный проход по памяти.
+// Одиночная вставка сдвигает хвост, поэтому большие наборы ключей лучше добавлять
+// через InsertBulk: добавление в конец, сортировка и слияние с удалением дубликатов за один проход
+template <typename Key, typename Compare = std::less<Key>, typename Search = BinarySearch>
+class FlatSet {
+public:
+    using Iterator = const Key*;
+    using ConstIterator = const Key*;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp)
+        :comp_(comp)
+    {
+    }
+
+    FlatSet(std::initializer_list<Key> init, const Compare& comp = Compare())
+        :comp_(comp)
+    {
+        InsertBulk(init.begin(), init.end());
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare())
+        :comp_(comp)
+    {
+        InsertBulk(first, last);
+    }
+
+    // Вставляет key, если его ещё нет.
+    // Возвращает итератор на элемент и признак того, что вставка произошла
+    std::pair<Iterator, bool> Insert(const Key& key) {
+        return InsertImpl(key);
+    }
+
+    std::pair<Iterator, bool> Insert(Key&& key) {
+        return InsertImpl(std::move(key));
+    }
+
+    // Вставляет элементы диапазона [first, last): одно добавление в конец,
+    // сортировка новых элементов и слияние с удалением дубликатов.
+    // При исключении множество остаётся прежним. Исключение: если ключи нетривиальны
+    // и перемещаются без исключений, а во время слияния бросает comp_, часть ключей
+    // уже перемещена, и множество очищается
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    void InsertBulk(InputIt first, InputIt last) {
+        const size_t old_size = keys_.GetSize();
+        keys_.Insert(keys_.cend(), first, last);
+        if(keys_.GetSize() == old_size){
+            return;
+        }
+        bool merging = false;
+        try {
+            std::stable_sort(keys_.begin() + old_size, keys_.end(), comp_);
+            SimpleVector<Key> merged(::Reserve(keys_.GetSize()));
+            merging = true;
+            detail::MergeUnique(keys_.begin(), keys_.begin() + old_size, keys_.end(), comp_, [&merged](auto&& key) -> Key& {
+                return merged.EmplaceBack(std::forward<decltype(key)>(key));
+            });
+            keys_ = std::move(merged);
+        } catch (...) {
+            if(merging && detail::kMoveIfNoexceptAltersSource<Key>){
+                keys_.Clear();
+            } else {
+                keys_.Erase(keys_.begin() + old_size, keys_.end());
+            }
+            throw;
+        }
+    }
+
+    void InsertBulk(std::initializer_list<Key> init) {
+        InsertBulk(init.begin(), init.end());
+    }
+
+    // Удаляет key. Возвращает количество удалённых элементов (0 или 1)
+    size_t Erase(const Key& key) {
+        const Iterator it = Find(key);
+        if(it == end()){
+            return 0;
+        }
+        Erase(it);
+        return 1;
+    }
+
+    // Удаляет элемент в позиции pos и возвращает итератор на следующий
+    Iterator Erase(ConstIterator pos) {
+        return keys_.Erase(pos);
+    }
+
+    Iterator Find(const Key& key) const {
+        const Iterator it = LowerBound(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    bool Contains(const Key& key) const {
+        return Find(key) != end();
+    }
+
+    size_t Count(const Key& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    // Первый элемент, не меньший key
+    Iterator LowerBound(const Key& key) const {
+        return begin() + Search::LowerBound(keys_.begin(), keys_.GetSize(), key, comp_);
+    }
+
+    // Первый элемент, больший key
+    Iterator UpperBound(const Key& key) const {
+        const Iterator it = LowerBound(key);
+        return it != end() && !comp_(key, *it) ? it + 1 : it;
+    }
+
+    size_t GetSize() const noexcept {
+        return keys_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return keys_.IsEmpty();
+    }
+
+    void Reserve(size_t new_capacity) {
+        keys_.Reserve(new_capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+    }
+
+    void swap(FlatSet& other) noexcept {
+        using std::swap;
+        swap(comp_, other.comp_);
+        keys_.swap(other.keys_);
+    }
+
+    // Отсортированные ключи
+    const SimpleVector<Key>& GetKeys() const noexcept {
+        return keys_;
+    }
+
+    Iterator begin() const noexcept {
+        return keys_.begin();
+    }
+
+    Iterator end() const noexcept {
+        return keys_.end();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    template <typename K>
+    std::pair<Iterator, bool> InsertImpl(K&& key) {
+        const size_t index = Search::LowerBound(keys_.begin(), keys_.GetSize(), key, comp_);
+        if(index != keys_.GetSize() && !comp_(key, keys_[index])){
+            return {begin() + index, false};
+        }
+        return {keys_.Insert(keys_.begin() + index, std::forward<K>(key)), true};
+    }
+
+    Compare comp_;
+    SimpleVector<Key> keys_;
+};
+
+template <typename Key, typename Compare, typename Search>
+inline bool operator==(const FlatSet<Key, Compare, Search>& lhs, const FlatSet<Key, Compare, Search>& rhs) {
+    return lhs.GetKeys() == rhs.GetKeys();
+}
+
+template <typename Key, typename Compare, typename Search>
+inline bool operator!=(const FlatSet<Key, Compare, Search>& lhs, const FlatSet<Key, Compare, Search>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Key, typename Compare, typename Search>
+inline bool operator<(const FlatSet<Key, Compare, Search>& lhs, const FlatSet<Key, Compare, Search>& rhs) {
+    return lhs.GetKeys() < rhs.GetKeys();
+}
+
+template <typename Key, typename Compare, typename Search>
+inline bool operator<=(const FlatSet<Key, Compare, Search>& lhs, const FlatSet<Key, Compare, Search>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Key, typename Compare, typename Search>
+inline bool operator>(const FlatSet<Key, Compare, Search>& lhs, const FlatSet<Key, Compare, Search>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Key, typename Compare, typename Search>
+inline bool operator>=(const FlatSet<Key, Compare, Search>& lhs, const FlatSet<Key, Compare, Search>& rhs) {
+    return !(lhs < rhs);
+}
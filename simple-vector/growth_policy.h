@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+// Политики роста вместимости SimpleVector.
+// NextCapacity получает текущую вместимость, требуемое число элементов
+// и размер элемента в байтах и возвращает новую вместимость (не меньше required)
+
+// Рост вдвое: 0 -> 1 -> 2 -> 4 -> ...
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity == 0 ? size_t{1} : capacity * 2);
+    }
+};
+
+// Рост в 1.5 раза: суммарный размер освобождённых ранее блоков со временем
+// превышает размер нового, и аллокатор может переиспользовать эту память
+struct HalfGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        return std::max(required, capacity < 2 ? capacity + 1 : capacity + capacity / 2);
+    }
+};
+
+// Округляет вместимость, выбранную политикой Base, до размерного класса аллокатора:
+// блоки меньше страницы - до степени двойки (не меньше kMinBlock байт),
+// большие блоки - до целого числа страниц kPageSize.
+// Так в хвосте блока не пропадает память, которую аллокатор всё равно отдал
+template <typename Base = DoublingGrowth, size_t kPageSize = 4096, size_t kMinBlock = 16>
+struct SizeClassGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t base = Base::NextCapacity(capacity, required, element_size);
+        const size_t bytes = base * element_size;
+        size_t block = kMinBlock;
+        if(bytes > kPageSize){
+            block = (bytes + kPageSize - 1) / kPageSize * kPageSize;
+        } else {
+            while(block < bytes){
+                block *= 2;
+            }
+        }
+        return std::max(base, block / element_size);
+    }
+};
@@ -4,6 +4,8 @@
 #include <utility>
 
 #include "simple_vector.h"
+#include "small_simple_vector.h"
+#include "tests.h"
 
 using namespace std;
 
@@ -147,14 +149,37 @@ void TestNoncopiableErase() {
     v.Resize(10);
 
     {
-        //SimpleVector<X> vv(5);
+        SimpleVector<X> vv(5);
+        assert(vv[4].GetX() == 5);
     }
     auto it = v.Erase(v.begin());
     assert(it->GetX() == 1);
     cout << "Done!" << endl << endl;
 }
 
+void TestNoncopiableEmplace() {
+    cout << "Test noncopiable emplace" << endl;
+    SimpleVector<X> v;
+    v.EmplaceBack(1);
+    v.EmplaceBack();
+    v.Emplace(v.begin(), 7);
+    assert(v[0].GetX() == 7 && v[1].GetX() == 1 && v[2].GetX() == 5);
+
+    SmallSimpleVector<X, 2> small;
+    small.EmplaceBack(1);
+    small.Emplace(small.begin(), 2);
+    small.Emplace(small.begin() + 1, 3);
+    assert(small[0].GetX() == 2 && small[1].GetX() == 3 && small[2].GetX() == 1);
+    cout << "Done!" << endl << endl;
+}
+
 int main() {
+    Test1();
+    Test2();
+    TestRawStorage();
+    TestAllocator();
+    TestRelocation();
+    TestMmapAllocator();
     TestTemporaryObjConstructor();
     TestTemporaryObjOperator();
     TestNamedMoveConstructor();
@@ -163,6 +188,28 @@ int main() {
     TestNoncopiablePushBack();
     TestNoncopiableInsert();
     TestNoncopiableErase();
+    TestSmallSimpleVector();
+    TestEmplace();
+    TestNoncopiableEmplace();
+    TestRangeInsert();
+    TestRangeErase();
+    TestGrowthPolicy();
+    TestResizeDefaultInit();
+    TestAlignedStorage();
+    TestComparisonKernels();
+    TestParallelConstruction();
+    TestMappedSimpleVector();
+    TestSerialization();
+    TestConcurrentSimpleVector();
+    TestSegmentedVector();
+    TestCowSimpleVector();
+    TestSimpleVectorView();
+    TestSoAVector();
+    TestStatsPolicy();
+    TestConstexprSimpleVector();
+    TestStaticVector();
+    TestFlatSet();
+    TestFlatMap();
     return 0;
 }
 
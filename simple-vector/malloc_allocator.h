@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+// Аллокатор поверх malloc/realloc/free.
+// Reallocate позволяет SimpleVector расти на месте для IsTriviallyRelocatable-типов
+template <typename Type>
+class MallocAllocator {
+public:
+    using value_type = Type;
+    using is_always_equal = std::true_type;
+
+    static_assert(alignof(Type) <= alignof(std::max_align_t),
+                  "malloc does not guarantee alignment of over-aligned types");
+
+    MallocAllocator() noexcept = default;
+
+    template <typename Other>
+    MallocAllocator(const MallocAllocator<Other>&) noexcept {
+    }
+
+    Type* allocate(size_t size) {
+        return static_cast<Type*>(CheckResult(std::malloc(Bytes(size))));
+    }
+
+    void deallocate(Type* ptr, size_t) noexcept {
+        std::free(ptr);
+    }
+
+    // Изменяет размер блока; содержимое переносится побайтово.
+    // При нехватке памяти выбрасывает std::bad_alloc, исходный блок остаётся нетронутым
+    Type* Reallocate(Type* ptr, size_t, size_t new_size) {
+        return static_cast<Type*>(CheckResult(std::realloc(ptr, Bytes(new_size))));
+    }
+
+private:
+    static size_t Bytes(size_t size) {
+        if(size > std::numeric_limits<size_t>::max() / sizeof(Type)){
+            throw std::bad_array_new_length();
+        }
+        return size * sizeof(Type);
+    }
+
+    static void* CheckResult(void* ptr) {
+        if(ptr == nullptr){
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+};
+
+template <typename Type, typename Other>
+bool operator==(const MallocAllocator<Type>&, const MallocAllocator<Other>&) noexcept {
+    return true;
+}
+
+template <typename Type, typename Other>
+bool operator!=(const MallocAllocator<Type>&, const MallocAllocator<Other>&) noexcept {
+    return false;
+}
@@ -0,0 +1,339 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "compare_kernels.h"
+#include "growth_policy.h"
+
+// Вектор тривиально копируемых элементов, хранящийся в файле, отображённом в память.
+// Открытие существующего файла не читает и не разбирает данные: элементы доступны
+// сразу после mmap, страницы подгружаются ядром по мере обращения.
+// Рост удлиняет файл (ftruncate) и отображает его заново; данные при этом не копируются.
+// Формат файла: заголовок Header, затем элементы подряд, начиная со смещения kDataOffset
+template <typename Type>
+class MappedSimpleVector {
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    static_assert(std::is_trivially_copyable_v<Type>, "MappedSimpleVector requires a trivially copyable type");
+    static_assert(alignof(Type) <= 64, "MappedSimpleVector supports alignment up to 64 bytes");
+
+    static constexpr uint32_t kVersion = 1;
+
+    // Открывает файл path, создавая его, если он не существует.
+    // Выбрасывает std::system_error при ошибке ввода-вывода и std::runtime_error,
+    // если файл не является вектором этого типа
+    explicit MappedSimpleVector(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if(fd_ < 0){
+            ThrowSystemError("open " + path);
+        }
+        try {
+            struct stat info;
+            if(::fstat(fd_, &info) != 0){
+                ThrowSystemError("fstat " + path);
+            }
+            if(info.st_size == 0){
+                Truncate(kDataOffset);
+                SetMapping(MapFile(kDataOffset), kDataOffset);
+                Header& header = GetHeader();
+                std::memcpy(header.magic, kMagic, sizeof(header.magic));
+                header.version = kVersion;
+                header.element_size = sizeof(Type);
+                header.size = 0;
+            } else {
+                if(static_cast<size_t>(info.st_size) < kDataOffset){
+                    throw std::runtime_error(path + ": file is too small");
+                }
+                SetMapping(MapFile(static_cast<size_t>(info.st_size)), static_cast<size_t>(info.st_size));
+                CheckHeader(path);
+            }
+        } catch (...) {
+            Close();
+            throw;
+        }
+    }
+
+    MappedSimpleVector(const MappedSimpleVector&) = delete;
+    MappedSimpleVector& operator=(const MappedSimpleVector&) = delete;
+
+    // Перемещённый вектор пуст и не связан с файлом: его можно только
+    // читать (GetSize, begin/end), присвоить или разрушить
+    MappedSimpleVector(MappedSimpleVector&& other) noexcept
+        :fd_(std::exchange(other.fd_, -1))
+        ,mapping_(std::exchange(other.mapping_, nullptr))
+        ,mapping_size_(std::exchange(other.mapping_size_, 0))
+    {
+    }
+
+    MappedSimpleVector& operator=(MappedSimpleVector&& rhs) noexcept {
+        if(&rhs != this){
+            Close();
+            fd_ = std::exchange(rhs.fd_, -1);
+            mapping_ = std::exchange(rhs.mapping_, nullptr);
+            mapping_size_ = std::exchange(rhs.mapping_size_, 0);
+        }
+        return *this;
+    }
+
+    // Изменения, не сброшенные Flush, записываются ядром в файл позже
+    ~MappedSimpleVector() {
+        Close();
+    }
+
+    // Синхронно записывает изменения на диск
+    void Flush() {
+        if(mapping_ != nullptr && ::msync(mapping_, mapping_size_, MS_SYNC) != 0){
+            ThrowSystemError("msync");
+        }
+    }
+
+    void PushBack(const Type& item) {
+        if(GetSize() == GetCapacity()){
+            // item может ссылаться на элемент вектора, а он переедет при отображении заново
+            const Type tmp = item;
+            Reserve(DoublingGrowth::NextCapacity(GetCapacity(), GetSize() + 1, sizeof(Type)));
+            begin()[GetSize()] = tmp;
+        } else {
+            begin()[GetSize()] = item;
+        }
+        ++GetHeader().size;
+    }
+
+    // Удаляет последний элемент вектора. Вектор не должен быть пустым
+    void PopBack() noexcept {
+        assert(!IsEmpty());
+        --GetHeader().size;
+    }
+
+    // Удлиняет файл так, чтобы в нём помещалось new_capacity элементов
+    void Reserve(size_t new_capacity) {
+        if(new_capacity <= GetCapacity()){
+            return;
+        }
+        const size_t new_mapping_size = kDataOffset + new_capacity * sizeof(Type);
+        Truncate(new_mapping_size);
+        // старое отображение снимается, только когда новое уже создано
+        try {
+            SetMapping(MapFile(new_mapping_size), new_mapping_size);
+        } catch (...) {
+            // возвращаем файлу прежнюю длину; если и это не удалось, лишний хвост
+            // файла безвреден: CheckHeader принимает файл длиннее данных
+            [[maybe_unused]] const int restored = ::ftruncate(fd_, static_cast<off_t>(mapping_size_));
+            throw;
+        }
+    }
+
+    // Изменяет размер; новые элементы заполняются значением по умолчанию
+    void Resize(size_t new_size) {
+        const size_t old_size = GetSize();
+        if(new_size > GetCapacity()){
+            Reserve(DoublingGrowth::NextCapacity(GetCapacity(), new_size, sizeof(Type)));
+        }
+        if(new_size > old_size){
+            std::fill(begin() + old_size, begin() + new_size, Type());
+        }
+        GetHeader().size = new_size;
+    }
+
+    void Clear() noexcept {
+        if(mapping_ != nullptr){
+            GetHeader().size = 0;
+        }
+    }
+
+    size_t GetSize() const noexcept {
+        return mapping_ == nullptr ? 0 : GetHeader().size;
+    }
+
+    // Вместимость определяется длиной файла
+    size_t GetCapacity() const noexcept {
+        return mapping_ == nullptr ? 0 : (mapping_size_ - kDataOffset) / sizeof(Type);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < GetSize());
+        return begin()[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return begin()[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if(index >= GetSize()){
+            throw std::out_of_range("index >= size");
+        }
+        return begin()[index];
+    }
+
+    const Type& At(size_t index) const {
+        if(index >= GetSize()){
+            throw std::out_of_range("index >= size");
+        }
+        return begin()[index];
+    }
+
+    Iterator begin() noexcept {
+        if(mapping_ == nullptr){
+            return nullptr;
+        }
+        return reinterpret_cast<Type*>(static_cast<char*>(mapping_) + kDataOffset);
+    }
+
+    Iterator end() noexcept {
+        return begin() + GetSize();
+    }
+
+    ConstIterator begin() const noexcept {
+        if(mapping_ == nullptr){
+            return nullptr;
+        }
+        return reinterpret_cast<const Type*>(static_cast<const char*>(mapping_) + kDataOffset);
+    }
+
+    ConstIterator end() const noexcept {
+        return begin() + GetSize();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t element_size;
+        uint64_t size;
+    };
+
+    static constexpr char kMagic[8] = {'S', 'V', 'M', 'A', 'P', 'P', 'E', 'D'};
+    // Данные выровнены по 64 байта от начала файла (и страницы отображения)
+    static constexpr size_t kDataOffset = 64;
+
+    static_assert(sizeof(Header) <= kDataOffset);
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    Header& GetHeader() noexcept {
+        return *static_cast<Header*>(mapping_);
+    }
+
+    const Header& GetHeader() const noexcept {
+        return *static_cast<const Header*>(mapping_);
+    }
+
+    void CheckHeader(const std::string& path) const {
+        const Header& header = GetHeader();
+        if(std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0){
+            throw std::runtime_error(path + ": not a MappedSimpleVector file");
+        }
+        if(header.version != kVersion){
+            throw std::runtime_error(path + ": unsupported version " + std::to_string(header.version));
+        }
+        if(header.element_size != sizeof(Type)){
+            throw std::runtime_error(path + ": element size mismatch");
+        }
+        if(header.size > GetCapacity()){
+            throw std::runtime_error(path + ": file is truncated");
+        }
+    }
+
+    void Truncate(size_t length) {
+        if(::ftruncate(fd_, static_cast<off_t>(length)) != 0){
+            ThrowSystemError("ftruncate");
+        }
+    }
+
+    void* MapFile(size_t length) const {
+        void* mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if(mapping == MAP_FAILED){
+            ThrowSystemError("mmap");
+        }
+        return mapping;
+    }
+
+    void SetMapping(void* mapping, size_t length) noexcept {
+        Unmap();
+        mapping_ = mapping;
+        mapping_size_ = length;
+    }
+
+    void Unmap() noexcept {
+        if(mapping_ != nullptr){
+            ::munmap(mapping_, mapping_size_);
+            mapping_ = nullptr;
+            mapping_size_ = 0;
+        }
+    }
+
+    void Close() noexcept {
+        Unmap();
+        if(fd_ >= 0){
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+};
+
+template <typename Type>
+inline bool operator==(const MappedSimpleVector<Type>& lhs, const MappedSimpleVector<Type>& rhs) {
+    return detail::RangeEqual(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
+}
+
+template <typename Type>
+inline bool operator!=(const MappedSimpleVector<Type>& lhs, const MappedSimpleVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type>
+inline bool operator<(const MappedSimpleVector<Type>& lhs, const MappedSimpleVector<Type>& rhs) {
+    return detail::RangeLess(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
+}
+
+template <typename Type>
+inline bool operator<=(const MappedSimpleVector<Type>& lhs, const MappedSimpleVector<Type>& rhs) {
+    return !(lhs > rhs);
+}
+
+template <typename Type>
+inline bool operator>(const MappedSimpleVector<Type>& lhs, const MappedSimpleVector<Type>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type>
+inline bool operator>=(const MappedSimpleVector<Type>& lhs, const MappedSimpleVector<Type>& rhs) {
+    return !(lhs < rhs);
+}
@@ -0,0 +1,210 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Подсказки ядру для больших блоков MmapAllocator
+enum MmapHint : unsigned {
+    kMmapNoHints = 0,
+    // Прозрачные huge pages (MADV_HUGEPAGE): меньше промахов TLB на больших буферах
+    kMmapHugePages = 1u << 0,
+    // Страницы подгружаются сразу при выделении и росте (MAP_POPULATE / MADV_POPULATE_WRITE),
+    // так что Reserve платит за page fault заранее, а не при первой записи
+    kMmapPopulate = 1u << 1,
+};
+
+// Аллокатор для очень больших векторов.
+// Блоки от kThresholdBytes выделяются анонимным mmap и растут через mremap:
+// ядро перемещает страницы, не копируя данные и не держа одновременно два буфера.
+// Меньшие блоки берутся из malloc. Reallocate позволяет SimpleVector
+// пользоваться этим для IsTriviallyRelocatable-типов.
+// Вне Linux все блоки берутся из malloc
+template <typename Type, size_t kThresholdBytes = (size_t{1} << 20)>
+class MmapAllocator {
+public:
+    using value_type = Type;
+    using is_always_equal = std::true_type;
+
+    template <typename Other>
+    struct rebind {
+        using other = MmapAllocator<Other, kThresholdBytes>;
+    };
+
+    static_assert(alignof(Type) <= alignof(std::max_align_t),
+                  "malloc does not guarantee alignment of over-aligned types");
+
+    explicit MmapAllocator(unsigned hints = kMmapNoHints) noexcept
+        :hints_(hints)
+    {
+    }
+
+    template <typename Other>
+    MmapAllocator(const MmapAllocator<Other, kThresholdBytes>& other) noexcept
+        :hints_(other.GetHints())
+    {
+    }
+
+    unsigned GetHints() const noexcept {
+        return hints_;
+    }
+
+    Type* allocate(size_t size) {
+        const size_t bytes = Bytes(size);
+        if(IsMapped(bytes)){
+            return static_cast<Type*>(Map(bytes));
+        }
+        return static_cast<Type*>(CheckResult(std::malloc(bytes)));
+    }
+
+    void deallocate(Type* ptr, size_t size) noexcept {
+        const size_t bytes = size * sizeof(Type);
+        if(IsMapped(bytes)){
+            Unmap(ptr, bytes);
+        } else {
+            std::free(ptr);
+        }
+    }
+
+    // Изменяет размер блока; содержимое переносится побайтово.
+    // Большой блок растёт через mremap, при переходе через порог данные копируются один раз.
+    // При нехватке памяти выбрасывает std::bad_alloc, исходный блок остаётся нетронутым
+    Type* Reallocate(Type* ptr, size_t old_size, size_t new_size) {
+        if(ptr == nullptr){
+            return allocate(new_size);
+        }
+        const size_t old_bytes = old_size * sizeof(Type);
+        const size_t new_bytes = Bytes(new_size);
+        const bool old_mapped = IsMapped(old_bytes);
+        const bool new_mapped = IsMapped(new_bytes);
+        if(!old_mapped && !new_mapped){
+            return static_cast<Type*>(CheckResult(std::realloc(ptr, new_bytes)));
+        }
+#ifdef __linux__
+        if(old_mapped && new_mapped){
+            return static_cast<Type*>(Remap(ptr, old_bytes, new_bytes));
+        }
+#endif
+        Type* result = allocate(new_size);
+        std::memcpy(static_cast<void*>(result), static_cast<const void*>(ptr), std::min(old_bytes, new_bytes));
+        deallocate(ptr, old_size);
+        return result;
+    }
+
+private:
+    static size_t Bytes(size_t size) {
+        if(size > std::numeric_limits<size_t>::max() / sizeof(Type)){
+            throw std::bad_array_new_length();
+        }
+        return size * sizeof(Type);
+    }
+
+    static void* CheckResult(void* ptr) {
+        if(ptr == nullptr){
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+#ifdef __linux__
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= kThresholdBytes && bytes != 0;
+    }
+
+    static size_t PageAlign(size_t bytes) noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return (bytes + page_size - 1) / page_size * page_size;
+    }
+
+    void* Map(size_t bytes) const {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if(hints_ & kMmapPopulate){
+            flags |= MAP_POPULATE;
+        }
+        void* ptr = mmap(nullptr, PageAlign(bytes), PROT_READ | PROT_WRITE, flags, -1, 0);
+        if(ptr == MAP_FAILED){
+            throw std::bad_alloc();
+        }
+        Advise(ptr, PageAlign(bytes));
+        return ptr;
+    }
+
+    void* Remap(void* ptr, size_t old_bytes, size_t new_bytes) const {
+        const size_t old_length = PageAlign(old_bytes);
+        const size_t new_length = PageAlign(new_bytes);
+        if(old_length == new_length){
+            return ptr;
+        }
+        void* result = mremap(ptr, old_length, new_length, MREMAP_MAYMOVE);
+        if(result == MAP_FAILED){
+            throw std::bad_alloc();
+        }
+        if(new_length > old_length){
+            Advise(static_cast<char*>(result), new_length);
+            Prefault(static_cast<char*>(result) + old_length, new_length - old_length);
+        }
+        return result;
+    }
+
+    static void Unmap(void* ptr, size_t bytes) noexcept {
+        munmap(ptr, PageAlign(bytes));
+    }
+
+    void Advise([[maybe_unused]] void* ptr, [[maybe_unused]] size_t length) const noexcept {
+#ifdef MADV_HUGEPAGE
+        if(hints_ & kMmapHugePages){
+            madvise(ptr, length, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    // Подгружает страницы, добавленные mremap (MAP_POPULATE действует только при mmap)
+    void Prefault(char* ptr, size_t length) const noexcept {
+        if(!(hints_ & kMmapPopulate)){
+            return;
+        }
+#ifdef MADV_POPULATE_WRITE
+        if(madvise(ptr, length, MADV_POPULATE_WRITE) == 0){
+            return;
+        }
+#endif
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for(size_t offset = 0; offset < length; offset += page_size){
+            // новые анонимные страницы заполнены нулями, запись нуля их не меняет
+            static_cast<volatile char*>(ptr)[offset] = 0;
+        }
+    }
+#else
+    static bool IsMapped(size_t) noexcept {
+        return false;
+    }
+
+    void* Map(size_t) const {
+        return nullptr;
+    }
+
+    static void Unmap(void*, size_t) noexcept {
+    }
+#endif
+
+    unsigned hints_ = kMmapNoHints;
+};
+
+template <typename Type, typename Other, size_t kThresholdBytes>
+bool operator==(const MmapAllocator<Type, kThresholdBytes>&, const MmapAllocator<Other, kThresholdBytes>&) noexcept {
+    return true;
+}
+
+template <typename Type, typename Other, size_t kThresholdBytes>
+bool operator!=(const MmapAllocator<Type, kThresholdBytes>&, const MmapAllocator<Other, kThresholdBytes>&) noexcept {
+    return false;
+}
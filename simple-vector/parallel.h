@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Параметры параллельного конструирования и копирования SimpleVector.
+// Работа делится на непрерывные куски по потокам; каждый поток сам первым
+// записывает свои страницы, так что на NUMA-машинах они оказываются в его узле
+struct ParallelPolicy {
+    // Число потоков; 0 - std::thread::hardware_concurrency()
+    size_t threads = 0;
+    // Меньшие диапазоны обрабатываются одним потоком: запуск потоков дороже работы
+    size_t serial_threshold = size_t{1} << 16;
+};
+
+inline constexpr ParallelPolicy kParallel{};
+
+namespace detail {
+
+// Число кусков, на которые стоит делить count элементов
+inline size_t ChunkCount(size_t count, const ParallelPolicy& policy) noexcept {
+    if(count < policy.serial_threshold || count < 2){
+        return 1;
+    }
+    size_t threads = policy.threads != 0 ? policy.threads : std::thread::hardware_concurrency();
+    threads = std::max<size_t>(threads, 1);
+    const size_t min_chunk = std::max<size_t>(policy.serial_threshold / 2, 1);
+    return std::max<size_t>(1, std::min(threads, count / min_chunk));
+}
+
+// Вызывает body(first, last) для кусков диапазона [0, count) в нескольких потоках;
+// первый кусок обрабатывается вызывающим потоком.
+// Если body бросило исключение хотя бы в одном куске, для всех успешно обработанных
+// кусков вызывается rollback(first, last), после чего исключение пробрасывается дальше
+template <typename Body, typename Rollback>
+void ParallelForChunks(size_t count, const ParallelPolicy& policy, Body body, Rollback rollback) {
+    const size_t chunks = ChunkCount(count, policy);
+    if(chunks == 1){
+        body(size_t{0}, count);
+        return;
+    }
+    auto chunk_begin = [count, chunks](size_t chunk) {
+        return count / chunks * chunk + std::min(chunk, count % chunks);
+    };
+    std::vector<std::exception_ptr> errors(chunks);
+    auto run_chunk = [&](size_t chunk) {
+        try {
+            body(chunk_begin(chunk), chunk_begin(chunk + 1));
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for(size_t chunk = 1; chunk < chunks; ++chunk){
+        try {
+            workers.emplace_back(run_chunk, chunk);
+        } catch (const std::system_error&) {
+            // поток не удалось создать - обрабатываем кусок сами
+            run_chunk(chunk);
+        }
+    }
+    run_chunk(0);
+    for(std::thread& worker : workers){
+        worker.join();
+    }
+
+    std::exception_ptr first_error;
+    for(size_t chunk = 0; chunk < chunks; ++chunk){
+        if(errors[chunk] && !first_error){
+            first_error = errors[chunk];
+        }
+    }
+    if(first_error){
+        for(size_t chunk = 0; chunk < chunks; ++chunk){
+            if(!errors[chunk]){
+                rollback(chunk_begin(chunk), chunk_begin(chunk + 1));
+            }
+        }
+        std::rethrow_exception(first_error);
+    }
+}
+
+} // namespace detail
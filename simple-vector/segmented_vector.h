@@ -0,0 +1,569 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "array_ptr.h"
+#include "compare_kernels.h"
+#include "simple_vector.h"
+
+namespace detail {
+
+// Число элементов в куске по умолчанию: наибольшая степень двойки,
+// при которой кусок занимает не больше 64 КиБ (но не меньше 16 элементов)
+template <typename Type>
+constexpr size_t DefaultChunkSize() noexcept {
+    size_t size = 16;
+    while(size * 2 * sizeof(Type) <= (size_t{1} << 16)){
+        size *= 2;
+    }
+    return size;
+}
+
+} // namespace detail
+
+// Вектор, хранящий элементы кусками по kChunkSize штук.
+// Рост выделяет только новый кусок: элементы никогда не копируются при увеличении
+// вместимости, а ссылки и указатели на них остаются действительными до удаления элемента.
+// Копируется лишь таблица указателей на куски, в kChunkSize раз меньшая данных.
+// Итераторы хранят номер элемента и остаются действительными при добавлении в конец;
+// горячие циклы лучше писать через ForEachChunk, получая непрерывные диапазоны
+template <typename Type, size_t kChunkSize = detail::DefaultChunkSize<Type>(),
+          typename Alloc = std::allocator<Type>>
+class SegmentedVector {
+    template <bool kConst>
+    class BasicIterator;
+
+public:
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    static_assert(kChunkSize > 0 && (kChunkSize & (kChunkSize - 1)) == 0,
+                  "chunk size must be a power of two");
+
+    SegmentedVector() noexcept = default;
+
+    explicit SegmentedVector(const Alloc& alloc) noexcept
+        :alloc_(alloc)
+    {
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit SegmentedVector(size_t size, const Alloc& alloc = Alloc())
+        :SegmentedVector(alloc)
+    {
+        Resize(size);
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    SegmentedVector(size_t size, const Type& value, const Alloc& alloc = Alloc())
+        :SegmentedVector(alloc)
+    {
+        Resize(size, value);
+    }
+
+    // Создаёт вектор из std::initializer_list
+    SegmentedVector(std::initializer_list<Type> init, const Alloc& alloc = Alloc())
+        :SegmentedVector(alloc)
+    {
+        Reserve(init.size());
+        for(const Type& item : init){
+            EmplaceBack(item);
+        }
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+        :SegmentedVector(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_))
+    {
+        Reserve(other.GetSize());
+        other.ForEachChunk([this](const Type* first, const Type* last) {
+            Type* dest = EndSlot();
+            detail::UninitializedCopy(alloc_, first, last, dest);
+            size_ += last - first;
+        });
+    }
+
+    // Забирает таблицу кусков целиком, элементы не перемещаются
+    SegmentedVector(SegmentedVector&& other) noexcept
+        :alloc_(other.alloc_)
+        ,chunks_(std::move(other.chunks_))
+        ,size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    ~SegmentedVector() {
+        Clear();
+        ReleaseChunks(0);
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if(this != &rhs){
+            SegmentedVector tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+        if(this != &rhs){
+            SegmentedVector tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    // Добавляет элемент в конец вектора
+    // При нехватке места выделяется новый кусок; существующие элементы остаются на месте
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Конструирует элемент в конце вектора из args и возвращает ссылку на него
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if(size_ == GetCapacity()){
+            AddChunk();
+        }
+        Type* slot = EndSlot();
+        AllocTraits::construct(alloc_, slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    // Вставляет значение value в позицию pos.
+    // Возвращает итератор на вставленное значение
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Конструирует элемент в позиции pos, сдвигая хвост на одну позицию вправо
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        assert(pos.index_ <= size_);
+        const size_t index = pos.index_;
+        EmplaceBack(std::forward<Args>(args)...);
+        std::rotate(begin() + index, end() - 1, end());
+        return begin() + index;
+    }
+
+    // "Удаляет" последний элемент вектора. Вектор не должен быть пустым
+    void PopBack() noexcept {
+        assert(!IsEmpty());
+        --size_;
+        AllocTraits::destroy(alloc_, EndSlot());
+    }
+
+    // Удаляет элемент вектора в указанной позиции
+    Iterator Erase(ConstIterator pos) {
+        assert(pos.index_ < size_);
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет элементы [first, last), сдвигая хвост влево.
+    // Возвращает итератор на элемент, следовавший за удалёнными
+    Iterator Erase(ConstIterator first, ConstIterator last) {
+        assert(first.index_ <= last.index_ && last.index_ <= size_);
+        const size_t count = last.index_ - first.index_;
+        std::move(begin() + last.index_, end(), begin() + first.index_);
+        for(size_t i = 0; i < count; ++i){
+            PopBack();
+        }
+        return begin() + first.index_;
+    }
+
+    // Обменивает значение с другим вектором
+    void swap(SegmentedVector& other) noexcept {
+        using std::swap;
+        if constexpr (std::is_swappable_v<Alloc>) {
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
+        chunks_.swap(other.chunks_);
+        swap(size_, other.size_);
+    }
+
+    // Возвращает количество элементов в массиве
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает вместимость: число элементов в уже выделенных кусках
+    size_t GetCapacity() const noexcept {
+        return chunks_.GetSize() * kChunkSize;
+    }
+
+    // Сообщает, пустой ли массив
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Число выделенных кусков
+    size_t GetChunkCount() const noexcept {
+        return chunks_.GetSize();
+    }
+
+    // Выделяет куски так, чтобы вместилось new_capacity элементов
+    void Reserve(size_t new_capacity) {
+        const size_t chunk_count = (new_capacity + kChunkSize - 1) / kChunkSize;
+        chunks_.Reserve(chunk_count);
+        while(chunks_.GetSize() < chunk_count){
+            AddChunk();
+        }
+    }
+
+    // Освобождает куски, в которых нет элементов
+    void ShrinkToFit() {
+        ReleaseChunks((size_ + kChunkSize - 1) / kChunkSize);
+        chunks_.ShrinkToFit();
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return chunks_[index / kChunkSize][index % kChunkSize];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return chunks_[index / kChunkSize][index % kChunkSize];
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if(index >= size_){
+            throw std::out_of_range("index out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        if(index >= size_){
+            throw std::out_of_range("index out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Обнуляет размер массива, не освобождая куски
+    void Clear() noexcept {
+        ForEachChunk([this](Type* first, Type* last) {
+            detail::Destroy(alloc_, first, last);
+        });
+        size_ = 0;
+    }
+
+    // Изменяет размер массива; новые элементы инициализируются значением по умолчанию
+    void Resize(size_t new_size) {
+        ResizeImpl(new_size);
+    }
+
+    // Изменяет размер массива; новые элементы - копии value
+    void Resize(size_t new_size, const Type& value) {
+        ResizeImpl(new_size, value);
+    }
+
+    // Вызывает func(first, last) для каждого непрерывного участка элементов по порядку
+    template <typename Func>
+    void ForEachChunk(Func func) {
+        ForEachChunk(begin(), end(), func);
+    }
+
+    template <typename Func>
+    void ForEachChunk(Func func) const {
+        ForEachChunk(begin(), end(), func);
+    }
+
+    // То же для диапазона [first, last): участки обрезаются по его границам
+    template <typename Func>
+    void ForEachChunk(ConstIterator first, ConstIterator last, Func func) {
+        VisitChunks(*this, first.index_, last.index_, func);
+    }
+
+    template <typename Func>
+    void ForEachChunk(ConstIterator first, ConstIterator last, Func func) const {
+        VisitChunks(*this, first.index_, last.index_, func);
+    }
+
+    Iterator begin() noexcept {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept {
+        return Iterator(this, size_);
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, size_);
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    // Итератор произвольного доступа: указатель на вектор и номер элемента.
+    // ChunkEnd() сообщает, сколько элементов подряд лежат в памяти непрерывно
+    template <bool kConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<kConst, const SegmentedVector, SegmentedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<kConst, const Type*, Type*>;
+        using reference = std::conditional_t<kConst, const Type&, Type&>;
+
+        BasicIterator() noexcept = default;
+
+        // Неконстантный итератор приводится к константному
+        template <bool kOtherConst, typename = std::enable_if_t<kConst && !kOtherConst>>
+        BasicIterator(const BasicIterator<kOtherConst>& other) noexcept
+            :owner_(other.owner_)
+            ,index_(other.index_)
+        {
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        // Указатель за концом непрерывного участка, которому принадлежит элемент
+        pointer ChunkEnd() const noexcept {
+            const size_t chunk_last = std::min(owner_->size_, (index_ / kChunkSize + 1) * kChunkSize);
+            return &**this + (chunk_last - index_);
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator tmp = *this;
+            ++index_;
+            return tmp;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator tmp = *this;
+            --index_;
+            return tmp;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept {
+            return it += offset;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept {
+            return it -= offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return rhs < lhs;
+        }
+
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return !(rhs < lhs);
+        }
+
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return !(lhs < rhs);
+        }
+
+    private:
+        friend class SegmentedVector;
+        template <bool>
+        friend class BasicIterator;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            :owner_(owner)
+            ,index_(index)
+        {
+        }
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    template <typename Self, typename Func>
+    static void VisitChunks(Self& self, size_t first, size_t last, Func& func) {
+        while(first < last){
+            const size_t chunk = first / kChunkSize;
+            const size_t chunk_last = std::min(last, (chunk + 1) * kChunkSize);
+            auto* data = self.chunks_[chunk];
+            func(data + first % kChunkSize, data + (chunk_last - chunk * kChunkSize));
+            first = chunk_last;
+        }
+    }
+
+    // Ячейка для следующего элемента; кусок под неё должен быть выделен
+    Type* EndSlot() noexcept {
+        return chunks_[size_ / kChunkSize] + size_ % kChunkSize;
+    }
+
+    void AddChunk() {
+        Type* chunk = AllocTraits::allocate(alloc_, kChunkSize);
+        try {
+            chunks_.PushBack(chunk);
+        } catch (...) {
+            AllocTraits::deallocate(alloc_, chunk, kChunkSize);
+            throw;
+        }
+    }
+
+    // Освобождает куски, начиная с номера first_chunk
+    void ReleaseChunks(size_t first_chunk) noexcept {
+        while(chunks_.GetSize() > first_chunk){
+            AllocTraits::deallocate(alloc_, chunks_[chunks_.GetSize() - 1], kChunkSize);
+            chunks_.PopBack();
+        }
+    }
+
+    template <typename... Args>
+    void ResizeImpl(size_t new_size, const Args&... args) {
+        while(size_ > new_size){
+            PopBack();
+        }
+        if(new_size > size_){
+            Reserve(new_size);
+            while(size_ < new_size){
+                // кусок заполняется за один вызов, без проверки вместимости на каждом элементе
+                const size_t chunk_last = std::min(new_size, (size_ / kChunkSize + 1) * kChunkSize);
+                Type* first = EndSlot();
+                detail::UninitializedConstruct(alloc_, first, first + (chunk_last - size_), args...);
+                size_ = chunk_last;
+            }
+        }
+    }
+
+    Alloc alloc_;
+    SimpleVector<Type*> chunks_;
+    size_t size_ = 0;
+};
+
+// Куски двух векторов покрывают одни и те же номера элементов,
+// поэтому сравнение идёт по кускам векторными ядрами
+template <typename Type, size_t kChunkSize, typename Alloc>
+inline bool operator==(const SegmentedVector<Type, kChunkSize, Alloc>& lhs,
+                       const SegmentedVector<Type, kChunkSize, Alloc>& rhs) {
+    if(lhs.GetSize() != rhs.GetSize()){
+        return false;
+    }
+    for(size_t first = 0; first < lhs.GetSize(); first += kChunkSize){
+        const size_t count = std::min(kChunkSize, lhs.GetSize() - first);
+        if(!detail::RangeEqual(&lhs[first], count, &rhs[first], count)){
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Type, size_t kChunkSize, typename Alloc>
+inline bool operator!=(const SegmentedVector<Type, kChunkSize, Alloc>& lhs,
+                       const SegmentedVector<Type, kChunkSize, Alloc>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t kChunkSize, typename Alloc>
+inline bool operator<(const SegmentedVector<Type, kChunkSize, Alloc>& lhs,
+                      const SegmentedVector<Type, kChunkSize, Alloc>& rhs) {
+    const size_t common = std::min(lhs.GetSize(), rhs.GetSize());
+    for(size_t first = 0; first < common; first += kChunkSize){
+        const size_t lhs_count = std::min(kChunkSize, lhs.GetSize() - first);
+        const size_t rhs_count = std::min(kChunkSize, rhs.GetSize() - first);
+        const size_t count = std::min(lhs_count, rhs_count);
+        if(!detail::RangeEqual(&lhs[first], count, &rhs[first], count)){
+            return detail::RangeLess(&lhs[first], count, &rhs[first], count);
+        }
+    }
+    return lhs.GetSize() < rhs.GetSize();
+}
+
+template <typename Type, size_t kChunkSize, typename Alloc>
+inline bool operator<=(const SegmentedVector<Type, kChunkSize, Alloc>& lhs,
+                       const SegmentedVector<Type, kChunkSize, Alloc>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type, size_t kChunkSize, typename Alloc>
+inline bool operator>(const SegmentedVector<Type, kChunkSize, Alloc>& lhs,
+                      const SegmentedVector<Type, kChunkSize, Alloc>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, size_t kChunkSize, typename Alloc>
+inline bool operator>=(const SegmentedVector<Type, kChunkSize, Alloc>& lhs,
+                       const SegmentedVector<Type, kChunkSize, Alloc>& rhs) {
+    return !(lhs < rhs);
+}
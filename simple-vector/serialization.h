@@ -0,0 +1,351 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "simple_vector.h"
+
+// Двоичное сохранение и загрузка SimpleVector.
+// Формат: заголовок (сигнатура, версия, размер элемента, число элементов), затем элементы.
+// Тривиально копируемые элементы пишутся и читаются одним блоком байтов в порядке
+// байтов машины; остальные - через точку настройки ElementSerializer<Type>.
+// Длины из потока не проверены, поэтому память под них выделяется кусками
+// не больше kLoadChunkBytes по мере фактического чтения данных
+
+// Заголовок потока. element_size == 0 означает поэлементную запись через ElementSerializer
+struct SerializedHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t element_size;
+    uint64_t size;
+};
+
+inline constexpr char kSerializedMagic[8] = {'S', 'V', 'E', 'C', 'T', 'O', 'R', '\0'};
+inline constexpr uint32_t kSerializedVersion = 1;
+
+// Размер куска потокового чтения в байтах
+inline constexpr size_t kLoadChunkBytes = size_t{1} << 20;
+
+// Сколько кусков LoadFrom резервирует заранее, если размер из заголовка не проверить
+inline constexpr size_t kLoadReserveChunks = 4;
+
+// Источник байтов поверх std::istream
+class StreamSource {
+public:
+    explicit StreamSource(std::istream& in) noexcept
+        :in_(&in)
+    {
+    }
+
+    // Читает до bytes байт; меньше возвращается только в конце потока
+    size_t Read(void* data, size_t bytes) {
+        in_->read(static_cast<char*>(data), static_cast<std::streamsize>(bytes));
+        if(in_->bad()){
+            throw std::runtime_error("stream read failed");
+        }
+        return static_cast<size_t>(in_->gcount());
+    }
+
+private:
+    std::istream* in_;
+};
+
+// Приёмник байтов поверх std::ostream
+class StreamSink {
+public:
+    explicit StreamSink(std::ostream& out) noexcept
+        :out_(&out)
+    {
+    }
+
+    void Write(const void* data, size_t bytes) {
+        if(!out_->write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes))){
+            throw std::runtime_error("stream write failed");
+        }
+    }
+
+private:
+    std::ostream* out_;
+};
+
+// Источник байтов поверх файлового дескриптора (файл, сокет, канал)
+class FdSource {
+public:
+    explicit FdSource(int fd) noexcept
+        :fd_(fd)
+    {
+    }
+
+    size_t Read(void* data, size_t bytes) {
+        size_t done = 0;
+        while(done < bytes){
+            const ssize_t result = ::read(fd_, static_cast<char*>(data) + done, bytes - done);
+            if(result < 0){
+                if(errno == EINTR){
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+            if(result == 0){
+                break;
+            }
+            done += static_cast<size_t>(result);
+        }
+        return done;
+    }
+
+    // Число байт до конца обычного файла; UINT64_MAX, если дескриптор не файл
+    // или позицию узнать нельзя (сокет, канал)
+    uint64_t GetRemainingBytes() const noexcept {
+        struct stat info{};
+        if(::fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode)){
+            return UINT64_MAX;
+        }
+        const off_t position = ::lseek(fd_, 0, SEEK_CUR);
+        if(position < 0 || position > info.st_size){
+            return UINT64_MAX;
+        }
+        return static_cast<uint64_t>(info.st_size - position);
+    }
+
+private:
+    int fd_;
+};
+
+// Приёмник байтов поверх файлового дескриптора
+class FdSink {
+public:
+    explicit FdSink(int fd) noexcept
+        :fd_(fd)
+    {
+    }
+
+    void Write(const void* data, size_t bytes) {
+        size_t done = 0;
+        while(done < bytes){
+            const ssize_t result = ::write(fd_, static_cast<const char*>(data) + done, bytes - done);
+            if(result < 0){
+                if(errno == EINTR){
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "write");
+            }
+            done += static_cast<size_t>(result);
+        }
+    }
+
+private:
+    int fd_;
+};
+
+namespace detail {
+
+template <typename Source>
+void ReadExact(Source& source, void* data, size_t bytes) {
+    if(source.Read(data, bytes) != bytes){
+        throw std::runtime_error("unexpected end of serialized SimpleVector");
+    }
+}
+
+// Источник, знающий число оставшихся байт, позволяет проверить заголовок до чтения
+template <typename Source, typename = void>
+inline constexpr bool kHasRemainingBytes = false;
+
+template <typename Source>
+inline constexpr bool kHasRemainingBytes<Source,
+    std::void_t<decltype(std::declval<const Source&>().GetRemainingBytes())>> = true;
+
+} // namespace detail
+
+// Точка настройки для нетривиальных типов элементов. Специализация должна объявить
+//   template <typename Sink> static void Write(Sink& sink, const Type& value);
+//   template <typename Source> static Type Read(Source& source);
+// где sink.Write(data, bytes) пишет байты, а detail::ReadExact(source, data, bytes) читает их
+template <typename Type, typename = void>
+struct ElementSerializer;
+
+// Строки: длина, затем символы
+template <typename Char, typename Traits, typename Alloc>
+struct ElementSerializer<std::basic_string<Char, Traits, Alloc>> {
+    using String = std::basic_string<Char, Traits, Alloc>;
+
+    template <typename Sink>
+    static void Write(Sink& sink, const String& value) {
+        const uint64_t size = value.size();
+        sink.Write(&size, sizeof(size));
+        sink.Write(value.data(), value.size() * sizeof(Char));
+    }
+
+    // Длина не проверена, поэтому строка растёт кусками по мере чтения символов
+    template <typename Source>
+    static String Read(Source& source) {
+        static constexpr size_t kPiece = kLoadChunkBytes / sizeof(Char);
+        uint64_t size = 0;
+        detail::ReadExact(source, &size, sizeof(size));
+        String value;
+        if(size > value.max_size()){
+            throw std::runtime_error("serialized string is too long");
+        }
+        for(size_t done = 0; done < size;){
+            const size_t piece = static_cast<size_t>(std::min<uint64_t>(size - done, kPiece));
+            value.resize(done + piece);
+            detail::ReadExact(source, value.data() + done, piece * sizeof(Char));
+            done += piece;
+        }
+        return value;
+    }
+};
+
+// Сохраняет вектор в произвольный приёмник с методом Write(data, bytes)
+template <typename Sink, typename Type, typename Alloc, typename Growth, typename Stats>
+void SaveTo(Sink& sink, const SimpleVector<Type, Alloc, Growth, Stats>& vector) {
+    constexpr bool kBulk = std::is_trivially_copyable_v<Type>;
+    SerializedHeader header{};
+    std::memcpy(header.magic, kSerializedMagic, sizeof(header.magic));
+    header.version = kSerializedVersion;
+    header.element_size = kBulk ? static_cast<uint32_t>(sizeof(Type)) : 0;
+    header.size = vector.GetSize();
+    sink.Write(&header, sizeof(header));
+    if constexpr (kBulk) {
+        sink.Write(vector.begin(), vector.GetSize() * sizeof(Type));
+    } else {
+        for(const Type& item : vector){
+            ElementSerializer<Type>::Write(sink, item);
+        }
+    }
+}
+
+// Сохраняет вектор в поток
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+void Save(std::ostream& out, const SimpleVector<Type, Alloc, Growth, Stats>& vector) {
+    StreamSink sink(out);
+    SaveTo(sink, vector);
+}
+
+// Сохраняет вектор в файловый дескриптор
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+void Save(int fd, const SimpleVector<Type, Alloc, Growth, Stats>& vector) {
+    FdSink sink(fd);
+    SaveTo(sink, vector);
+}
+
+// Потоковое чтение сохранённого вектора кусками фиксированного размера.
+// Тривиально копируемые элементы читаются прямо в память вектора-приёмника,
+// без промежуточного буфера
+template <typename Type, typename Source = StreamSource>
+class SimpleVectorReader {
+public:
+    // Читает и проверяет заголовок
+    explicit SimpleVectorReader(Source source)
+        :source_(std::move(source))
+    {
+        SerializedHeader header{};
+        detail::ReadExact(source_, &header, sizeof(header));
+        if(std::memcmp(header.magic, kSerializedMagic, sizeof(header.magic)) != 0){
+            throw std::runtime_error("not a serialized SimpleVector");
+        }
+        if(header.version != kSerializedVersion){
+            throw std::runtime_error("unsupported SimpleVector format version " + std::to_string(header.version));
+        }
+        if(header.element_size != (kBulk ? sizeof(Type) : 0)){
+            throw std::runtime_error("serialized SimpleVector element type mismatch");
+        }
+        size_ = header.size;
+        if constexpr (kBulk && detail::kHasRemainingBytes<Source>) {
+            const uint64_t remaining = source_.GetRemainingBytes();
+            if(remaining != UINT64_MAX){
+                if(size_ > remaining / sizeof(Type)){
+                    throw std::runtime_error("unexpected end of serialized SimpleVector");
+                }
+                size_checked_ = true;
+            }
+        }
+    }
+
+    // Число элементов, записанное в заголовке: подсказка для Reserve.
+    // Данным из потока нельзя доверять, пока IsSizeChecked() не вернёт true
+    uint64_t GetSizeHint() const noexcept {
+        return size_;
+    }
+
+    // Сверен ли размер из заголовка с числом байт, оставшихся в источнике
+    bool IsSizeChecked() const noexcept {
+        return size_checked_;
+    }
+
+    // Число ещё не прочитанных элементов
+    uint64_t GetRemaining() const noexcept {
+        return size_ - read_;
+    }
+
+    // Дописывает в конец dest не более max_elements следующих элементов.
+    // Возвращает число прочитанных элементов; 0 - данные закончились
+    template <typename Alloc, typename Growth, typename Stats>
+    size_t ReadChunk(SimpleVector<Type, Alloc, Growth, Stats>& dest, size_t max_elements) {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(GetRemaining(), max_elements));
+        if constexpr (kBulk) {
+            const size_t old_size = dest.GetSize();
+            Type* chunk = dest.AppendDefaultInit(count);
+            const size_t bytes = source_.Read(chunk, count * sizeof(Type));
+            if(bytes != count * sizeof(Type)){
+                dest.Resize(old_size);
+                throw std::runtime_error("unexpected end of serialized SimpleVector");
+            }
+        } else {
+            for(size_t i = 0; i < count; ++i){
+                dest.EmplaceBack(ElementSerializer<Type>::template Read<Source>(source_));
+            }
+        }
+        read_ += count;
+        return count;
+    }
+
+private:
+    static constexpr bool kBulk = std::is_trivially_copyable_v<Type>;
+
+    Source source_;
+    uint64_t size_ = 0;
+    uint64_t read_ = 0;
+    bool size_checked_ = false;
+};
+
+// Заменяет содержимое vector данными из source. Память резервируется по заголовку,
+// если его удалось сверить с размером источника, иначе не больше kLoadReserveChunks кусков.
+// Данные читаются во временный вектор: при исключении vector не меняется
+template <typename Source, typename Type, typename Alloc, typename Growth, typename Stats>
+void LoadFrom(Source source, SimpleVector<Type, Alloc, Growth, Stats>& vector) {
+    SimpleVectorReader<Type, Source> reader(std::move(source));
+    const size_t chunk = std::max<size_t>(1, kLoadChunkBytes / sizeof(Type));
+    const uint64_t reserve = reader.IsSizeChecked()
+        ? reader.GetSizeHint()
+        : std::min<uint64_t>(reader.GetSizeHint(), uint64_t{chunk} * kLoadReserveChunks);
+    SimpleVector<Type, Alloc, Growth, Stats> loaded(vector.GetAllocator());
+    loaded.Reserve(static_cast<size_t>(reserve));
+    while(reader.ReadChunk(loaded, chunk) != 0){
+    }
+    vector.swap(loaded);
+}
+
+// Загружает вектор из потока
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+void Load(std::istream& in, SimpleVector<Type, Alloc, Growth, Stats>& vector) {
+    LoadFrom(StreamSource(in), vector);
+}
+
+// Загружает вектор из файлового дескриптора
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+void Load(int fd, SimpleVector<Type, Alloc, Growth, Stats>& vector) {
+    LoadFrom(FdSource(fd), vector);
+}
@@ -1,265 +1,493 @@
 ﻿#pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 
 #include "array_ptr.h"
+#include "compact_kernels.h"
+#include "compare_kernels.h"
+#include "growth_policy.h"
+#include "parallel.h"
+#include "stats_policy.h"
 
 class ReserveProxyObj{
 public:
     ReserveProxyObj() = delete;
-    ReserveProxyObj(size_t capacity)
+    constexpr ReserveProxyObj(size_t capacity)
         :capacity_(capacity){
 
     }
     size_t capacity_;
 };
 
-ReserveProxyObj Reserve(size_t capacity_to_reserve) {
+constexpr ReserveProxyObj Reserve(size_t capacity_to_reserve) {
     return ReserveProxyObj(capacity_to_reserve);
 }
 
+namespace detail {
+
+template <typename It, typename = void>
+struct IteratorCategory {
+};
+
+template <typename It>
+struct IteratorCategory<It, std::void_t<typename std::iterator_traits<It>::iterator_category>> {
+    using type = typename std::iterator_traits<It>::iterator_category;
+};
+
+// Отсекает перегрузки с итераторами, когда вызов вида Insert(pos, 3, 42) относится к count/value
+template <typename It>
+using RequireInputIterator = std::enable_if_t<
+    std::is_convertible_v<typename IteratorCategory<It>::type, std::input_iterator_tag>>;
+
+template <typename It>
+inline constexpr bool kIsForwardIterator =
+    std::is_convertible_v<typename IteratorCategory<It>::type, std::forward_iterator_tag>;
+
+// Итератор по последовательности из count копий одного значения
 template <typename Type>
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Type*;
+    using reference = const Type&;
+
+    constexpr RepeatIterator(const Type& value, size_t index) noexcept
+        :value_(&value)
+        ,index_(index)
+    {
+    }
+
+    constexpr reference operator*() const noexcept {
+        return *value_;
+    }
+
+    constexpr RepeatIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    constexpr RepeatIterator operator++(int) noexcept {
+        RepeatIterator tmp = *this;
+        ++index_;
+        return tmp;
+    }
+
+    constexpr bool operator==(const RepeatIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+
+    constexpr bool operator!=(const RepeatIterator& other) const noexcept {
+        return index_ != other.index_;
+    }
+
+private:
+    const Type* value_;
+    size_t index_;
+};
+
+} // namespace detail
+
+// Growth - политика роста вместимости (см. growth_policy.h),
+// Stats - политика статистики выделений и переносов (см. stats_policy.h)
+template <typename Type, typename Alloc = std::allocator<Type>, typename Growth = DoublingGrowth,
+          typename Stats = NoStats>
 class SimpleVector {
 public:
     using Iterator = Type*;
     using ConstIterator = const Type*;
+    using AllocatorType = Alloc;
+
+    // Выравнивание begin() непустого вектора, гарантированное аллокатором
+    static constexpr size_t kAlignment = detail::BlockAlignment<Alloc>::value;
 
-    SimpleVector() noexcept = default;
+    SimpleVector() noexcept(noexcept(Alloc())) = default;
+
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(const Alloc& alloc) noexcept
+        :arr_(alloc)
+    {
+    }
 
-    explicit SimpleVector(ReserveProxyObj obj)
-        :arr_(obj.capacity_)
-        ,size_(0)
-        ,capacity_(obj.capacity_)
+    // Резервирует память под obj.capacity_ элементов, не конструируя их
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(ReserveProxyObj obj, const Alloc& alloc = Alloc())
+        :arr_(obj.capacity_, alloc)
     {
+        RecordAllocate();
     }
 
     // Создаёт вектор из size элементов, инициализированных значением по умолчанию
-    explicit SimpleVector(size_t size) : SimpleVector(size, Type()){};
-//        :arr_(size)
-//        ,size_(size)
-//        ,capacity_(size)
-//    {
-//        FillDefVal(arr_.Get(), arr_.Get() + size);
-//        //std::fill(arr_.Get(), arr_.Get() + size, Type());
-//    }
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(size_t size, const Alloc& alloc = Alloc())
+        :arr_(size, alloc)
+    {
+        detail::UninitializedConstruct(GetAlloc(), arr_.Get(), arr_.Get() + size);
+        size_ = size;
+        RecordAllocate();
+    }
 
     // Создаёт вектор из size элементов, инициализированных значением value
-    explicit SimpleVector(size_t size, const Type& value )
-        :arr_(size)
-        ,size_(size)
-        ,capacity_(size)
+    SIMPLE_VECTOR_CONSTEXPR explicit SimpleVector(size_t size, const Type& value, const Alloc& alloc = Alloc())
+        :arr_(size, alloc)
+    {
+        detail::UninitializedConstruct(GetAlloc(), arr_.Get(), arr_.Get() + size, value);
+        size_ = size;
+        RecordAllocate();
+    }
+
+    // Параллельно создаёт вектор из size копий value (см. ParallelPolicy).
+    // Аллокатор должен допускать вызов construct из нескольких потоков
+    SimpleVector(size_t size, const Type& value, const ParallelPolicy& policy, const Alloc& alloc = Alloc())
+        :arr_(size, alloc)
     {
-        std::fill(arr_.Get(), arr_.Get() + size, value);
+        Type* data = arr_.Get();
+        detail::ParallelForChunks(size, policy, [this, data, &value](size_t first, size_t last) {
+            detail::UninitializedConstruct(GetAlloc(), data + first, data + last, value);
+        }, [this, data](size_t first, size_t last) {
+            detail::Destroy(GetAlloc(), data + first, data + last);
+        });
+        size_ = size;
+        RecordAllocate();
     }
 
     // Создаёт вектор из std::initializer_list
-    SimpleVector(std::initializer_list<Type> init)
-        :arr_(init.size())
-        ,size_(init.size())
-        ,capacity_(init.size())
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(std::initializer_list<Type> init, const Alloc& alloc = Alloc())
+        :arr_(init.size(), alloc)
     {
-        std::copy(init.begin(),init.end(),arr_.Get());
+        detail::UninitializedCopy(GetAlloc(), init.begin(), init.end(), arr_.Get());
+        size_ = init.size();
+        RecordAllocate();
     }
 
-    SimpleVector(const SimpleVector& other)
-        :arr_(other.GetCapacity())
-        ,size_(other.GetSize())
-        ,capacity_(other.GetCapacity())
+    // Создаёт вектор из элементов диапазона [first, last).
+    // Для forward-итераторов память выделяется один раз
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(InputIt first, InputIt last, const Alloc& alloc = Alloc())
+        :arr_(alloc)
     {
-        std::copy(other.begin(),other.end(),arr_.Get());
+        Insert(cbegin(), first, last);
     }
 
-    SimpleVector(SimpleVector&& other)
+    // Аллокатор копии выбирается через select_on_container_copy_construction
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(const SimpleVector& other)
+        :SimpleVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(const SimpleVector& other, const Alloc& alloc)
+        :arr_(other.GetCapacity(), alloc)
+    {
+        detail::UninitializedCopy(GetAlloc(), other.begin(), other.end(), arr_.Get());
+        size_ = other.GetSize();
+        RecordAllocate();
+        Stats::OnCopy(size_, sizeof(Type));
+    }
+
+    // Параллельно копирует other (см. ParallelPolicy).
+    // Тривиально копируемые элементы копируются через memcpy кусками по потокам
+    SimpleVector(const SimpleVector& other, const ParallelPolicy& policy)
+        :arr_(other.GetCapacity(), AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+        const Type* source = other.begin();
+        Type* data = arr_.Get();
+        detail::ParallelForChunks(other.GetSize(), policy, [this, source, data](size_t first, size_t last) {
+            detail::UninitializedCopy(GetAlloc(), source + first, source + last, data + first);
+        }, [this, data](size_t first, size_t last) {
+            detail::Destroy(GetAlloc(), data + first, data + last);
+        });
+        size_ = other.GetSize();
+        RecordAllocate();
+        Stats::OnCopy(size_, sizeof(Type));
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(SimpleVector&& other) noexcept
         :arr_(std::move(other.arr_))
         ,size_(std::exchange(other.size_, 0))
-        ,capacity_(std::exchange(other.capacity_, 0))
     {
     }
 
-    SimpleVector& operator=(const SimpleVector& rhs) {
+    // Если alloc не равен аллокатору other, элементы перемещаются по одному
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector(SimpleVector&& other, const Alloc& alloc)
+        :arr_(alloc)
+    {
+        if(alloc == other.GetAllocator()){
+            arr_ = std::move(other.arr_);
+            size_ = std::exchange(other.size_, 0);
+        } else {
+            ArrayPtr<Type, Alloc> tmp(other.GetSize(), alloc);
+            detail::UninitializedMove(tmp.GetAllocator(), other.begin(), other.end(), tmp.Get());
+            arr_ = std::move(tmp);
+            size_ = other.GetSize();
+            RecordAllocate();
+            Stats::OnRelocate(size_, sizeof(Type));
+        }
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR ~SimpleVector() {
+        if(GetCapacity() != 0){
+            Stats::OnRelease(size_, GetCapacity(), sizeof(Type));
+        }
+        detail::Destroy(GetAlloc(), begin(), end());
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector& operator=(const SimpleVector& rhs) {
         if(&rhs == this){
             return *this;
         }
-        SimpleVector<Type> tmp(rhs);
-        std::swap(*this, tmp);
-        size_ = rhs.GetSize();
-        capacity_ = rhs.GetCapacity();
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            SimpleVector tmp(rhs, rhs.GetAllocator());
+            SwapStorage(tmp);
+        } else {
+            SimpleVector tmp(rhs, GetAllocator());
+            SwapStorage(tmp);
+        }
         return *this;
     }
 
-    SimpleVector& operator=(SimpleVector&& rhs){
+    SIMPLE_VECTOR_CONSTEXPR SimpleVector& operator=(SimpleVector&& rhs)
+        noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                 || AllocTraits::is_always_equal::value) {
         if(&rhs == this){
             return *this;
         }
-        arr_ = std::move(rhs.arr_);
-        size_ = std::exchange(rhs.size_, 0);
-        capacity_ = std::exchange(rhs.capacity_, 0);
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+            SimpleVector tmp(std::move(rhs));
+            SwapStorage(tmp);
+        } else {
+            SimpleVector tmp(std::move(rhs), GetAllocator());
+            SwapStorage(tmp);
+        }
         return *this;
     }
 
+    // Возвращает копию аллокатора вектора
+    SIMPLE_VECTOR_CONSTEXPR Alloc GetAllocator() const noexcept {
+        return arr_.GetAllocator();
+    }
+
     // Добавляет элемент в конец вектора
-    // При нехватке места увеличивает вдвое вместимость вектора
-    void PushBack(const Type& item) {
-        if(size_ < capacity_ ){
-            arr_[size_++] = item;
-        } else {
-            if(capacity_ == 0 && size_ == 0 ){
-                ArrayPtr<Type> tmp(++capacity_);
-                tmp[size_++] = item;
-                arr_.swap(tmp);
-            } else {
-                ArrayPtr<Type> tmp(GetCapacity()*2);
-                std::copy(arr_.Get(), arr_.Get() + size_, tmp.Get());
-                tmp[size_++] = item;
-                arr_.swap(tmp);
-                capacity_*=2;
-            }
-        }
+    // При нехватке места увеличивает вместимость вектора по политике Growth
+    SIMPLE_VECTOR_CONSTEXPR void PushBack(const Type& item) {
+        EmplaceBack(item);
     }
 
-    void PushBack(Type&& item) {
-        if(size_ < capacity_ ){
-            arr_[size_++] = std::move(item);
-        } else {
-            if(capacity_ == 0 && size_ == 0 ){
-                ArrayPtr<Type> tmp(++capacity_);
-                tmp[size_++] = std::move(item);
-                arr_ = std::move(tmp);
-            } else {
-                ArrayPtr<Type> tmp(GetCapacity()*2);
-                std::move(arr_.Get(), arr_.Get() + size_, tmp.Get());
-                tmp[size_++] = std::move(item);
-                arr_ = std::move(tmp);
-                capacity_*=2;
-            }
-        }
+    SIMPLE_VECTOR_CONSTEXPR void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
     }
 
     // Вставляет значение value в позицию pos.
     // Возвращает итератор на вставленное значение
     // Если перед вставкой значения вектор был заполнен полностью,
-    // вместимость вектора должна увеличиться вдвое, а для вектора вместимостью 0 стать равной 1
-    Iterator Insert(ConstIterator pos, const Type& value) {
+    // вместимость вектора увеличивается по политике Growth
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Вставляет count копий value в позицию pos.
+    // Возвращает итератор на первый вставленный элемент
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, size_t count, const Type& value) {
         assert(pos >= cbegin() && pos <= cend());
-        Iterator res_pos = const_cast<Iterator>(pos);
-        if(size_ < capacity_ ){
-            std::copy_backward(res_pos, end(), end() + 1);
-            arr_[res_pos - begin()] = value;
+        const size_t pos_index = pos - cbegin();
+        if(count != 0){
+            // value может ссылаться на сдвигаемый элемент вектора
+            const Type tmp_value(value);
+            InsertForward(pos_index, detail::RepeatIterator<Type>(tmp_value, 0),
+                          detail::RepeatIterator<Type>(tmp_value, count), count);
+        }
+        return begin() + pos_index;
+    }
+
+    // Вставляет элементы диапазона [first, last) в позицию pos. Диапазон не должен
+    // указывать на элементы самого вектора. Для forward-итераторов вектор
+    // перевыделяет память не более одного раза и сдвигает хвост один раз.
+    // Возвращает итератор на первый вставленный элемент
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, InputIt first, InputIt last) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t pos_index = pos - cbegin();
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            const size_t count = static_cast<size_t>(std::distance(first, last));
+            if(count != 0){
+                InsertForward(pos_index, first, last, count);
+            }
+        } else if(pos == cend()) {
+            for(; first != last; ++first){
+                EmplaceBack(*first);
+            }
+        } else {
+            // длину однопроходного диапазона заранее не узнать: собираем его отдельно
+            SimpleVector tmp(first, last, GetAllocator());
+            Insert(begin() + pos_index, std::make_move_iterator(tmp.begin()), std::make_move_iterator(tmp.end()));
+        }
+        return begin() + pos_index;
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR Iterator Insert(ConstIterator pos, std::initializer_list<Type> init) {
+        return Insert(pos, init.begin(), init.end());
+    }
+
+    // Добавляет в конец вектора все элементы range (контейнера или массива)
+    template <typename Range>
+    SIMPLE_VECTOR_CONSTEXPR void Append(const Range& range) {
+        using std::begin;
+        using std::end;
+        Insert(cend(), begin(range), end(range));
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void Append(std::initializer_list<Type> init) {
+        Insert(cend(), init.begin(), init.end());
+    }
+
+    // Конструирует элемент из args прямо в конце вектора, без временного объекта.
+    // При нехватке места элемент создаётся сразу в новом буфере.
+    // Возвращает ссылку на созданный элемент
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Type& EmplaceBack(Args&&... args) {
+        if(size_ < GetCapacity()){
+            AllocTraits::construct(GetAlloc(), end(), std::forward<Args>(args)...);
             ++size_;
         } else {
-            if(capacity_ == 0 && size_ == 0 ){
-                ArrayPtr<Type> tmp(++capacity_);
-                tmp[size_++] = value;
-                arr_.swap(tmp);
-                res_pos = arr_.Get();
-            } else {
-                size_t posIndex = res_pos - begin();
-                ArrayPtr<Type> tmp(GetCapacity()*2);
-                auto it_tmp = std::copy(arr_.Get(),  res_pos, tmp.Get());
-                std::copy(res_pos, arr_.Get() + GetCapacity(), it_tmp + 1);
-                tmp[posIndex] = value;
-                arr_.swap(tmp);
-                ++size_;
-                capacity_*=2;
-                res_pos = &arr_[posIndex];
-            }
+            GrowAndEmplace(NextCapacity(size_ + 1), size_, std::forward<Args>(args)...);
         }
-        return res_pos;
+        return *(end() - 1);
     }
 
-    Iterator Insert(ConstIterator pos, Type&& value) {
+    // Конструирует элемент из args в позиции pos и возвращает итератор на него.
+    // В конце вектора и при реаллокации элемент создаётся сразу на своём месте.
+    // Если вставка в середину не требует реаллокации, элемент сначала создаётся
+    // во временном объекте: args могут ссылаться на сдвигаемые элементы вектора
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR Iterator Emplace(ConstIterator pos, Args&&... args) {
         assert(pos >= cbegin() && pos <= cend());
-        Iterator res_pos = const_cast<Iterator>(pos);
-        if(size_ < capacity_ ){
-            std::move_backward(res_pos, end(), end() + 1);
-            arr_[res_pos - begin()] = std::move(value);
+        const size_t pos_index = pos - cbegin();
+        if(pos == cend()){
+            EmplaceBack(std::forward<Args>(args)...);
+            return begin() + pos_index;
+        }
+        if(size_ == GetCapacity()){
+            GrowAndEmplace(NextCapacity(size_ + 1), pos_index, std::forward<Args>(args)...);
+            return begin() + pos_index;
+        }
+        Type tmp_value(std::forward<Args>(args)...);
+        if(RelocatesBytes()){
+            detail::RelocateBytes(begin() + pos_index, end(), begin() + pos_index + 1);
+            try {
+                AllocTraits::construct(GetAlloc(), begin() + pos_index, std::move(tmp_value));
+            } catch (...) {
+                detail::RelocateBytes(begin() + pos_index + 1, end() + 1, begin() + pos_index);
+                throw;
+            }
             ++size_;
         } else {
-            if(capacity_ == 0 && size_ == 0 ){
-                ArrayPtr<Type> tmp(++capacity_);
-                tmp[size_++] = std::move(value);
-                arr_ = std::move(tmp);
-                res_pos = arr_.Get();
-            } else {
-                size_t posIndex = pos - begin();
-                ArrayPtr<Type> tmp(GetCapacity()*2);
-                auto it_tmp = std::move(arr_.Get(),  res_pos, tmp.Get());
-                std::move(res_pos, arr_.Get() + GetCapacity(), it_tmp + 1);
-                tmp[posIndex] = std::move(value);
-                arr_ = std::move(tmp);
-                ++size_;
-                capacity_ *= 2;
-                res_pos = &arr_[posIndex];
-            }
+            AllocTraits::construct(GetAlloc(), end(), std::move(*(end() - 1)));
+            ++size_;
+            std::move_backward(begin() + pos_index, end() - 2, end() - 1);
+            arr_[pos_index] = std::move(tmp_value);
         }
-        return res_pos;
+        return begin() + pos_index;
     }
 
-    // "Удаляет" последний элемент вектора. Вектор не должен быть пустым
-    void PopBack() noexcept {
+    // Удаляет последний элемент вектора. Вектор не должен быть пустым
+    SIMPLE_VECTOR_CONSTEXPR void PopBack() noexcept {
         assert(!IsEmpty());
+        AllocTraits::destroy(GetAlloc(), end() - 1);
         --size_;
     }
 
     // Удаляет элемент вектора в указанной позиции
-    Iterator Erase(ConstIterator pos) {
+    SIMPLE_VECTOR_CONSTEXPR Iterator Erase(ConstIterator pos) {
         assert(pos >= cbegin() && pos <= cend());
         assert(!IsEmpty());
-        Iterator tmp_pos = const_cast<Iterator>(pos);
-        std::move(tmp_pos + 1, end(), tmp_pos);
-        --size_;
-        return tmp_pos;
+        return Erase(pos, pos + 1);
     }
 
-    // Обменивает значение с другим вектором
-    void swap(SimpleVector& other) noexcept {
-        arr_.swap(other.arr_);
-        std::swap(size_, other.size_);
-        std::swap(capacity_, other.capacity_);
+    // Удаляет элементы [first, last), сдвигая хвост один раз.
+    // Возвращает итератор на элемент, следовавший за удалёнными
+    SIMPLE_VECTOR_CONSTEXPR Iterator Erase(ConstIterator first, ConstIterator last) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        Iterator tmp_first = const_cast<Iterator>(first);
+        Iterator tmp_last = const_cast<Iterator>(last);
+        const size_t count = tmp_last - tmp_first;
+        if(count == 0){
+            return tmp_first;
+        }
+        if(RelocatesBytes()){
+            detail::Destroy(GetAlloc(), tmp_first, tmp_last);
+            detail::RelocateBytes(tmp_last, end(), tmp_first);
+        } else {
+            std::move(tmp_last, end(), tmp_first);
+            detail::Destroy(GetAlloc(), end() - count, end());
+        }
+        size_ -= count;
+        return tmp_first;
+    }
+
+    // Обменивает значение с другим вектором.
+    // Если аллокатор не распространяется при обмене, аллокаторы векторов должны быть равны
+    SIMPLE_VECTOR_CONSTEXPR void swap(SimpleVector& other) noexcept {
+        assert(AllocTraits::propagate_on_container_swap::value
+               || GetAllocator() == other.GetAllocator());
+        SwapStorage(other);
     }
 
     // Возвращает количество элементов в массиве
-    size_t GetSize() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR size_t GetSize() const noexcept {
         return size_;
     }
 
     // Возвращает вместимость массива
-    size_t GetCapacity() const noexcept {
-        return capacity_;
+    SIMPLE_VECTOR_CONSTEXPR size_t GetCapacity() const noexcept {
+        return arr_.GetSize();
     }
 
     // Сообщает, пустой ли массив
-    bool IsEmpty() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR bool IsEmpty() const noexcept {
         return size_ == 0;
     }
 
-    void Reserve(size_t new_capacity){
-        if(new_capacity <= capacity_){
+    SIMPLE_VECTOR_CONSTEXPR void Reserve(size_t new_capacity){
+        if(new_capacity <= GetCapacity()){
             return;
         }
-        ArrayPtr<Type> tmp(new_capacity);
-        std::move(arr_.Get(), arr_.Get() + size_, tmp.Get());
-        arr_.swap(tmp);
-        capacity_ = new_capacity;
+        ChangeCapacity(new_capacity);
     };
 
+    // Уменьшает вместимость до размера, возвращая лишнюю память аллокатору.
+    // Полезно после массового удаления элементов
+    SIMPLE_VECTOR_CONSTEXPR void ShrinkToFit() {
+        if(size_ < GetCapacity()){
+            ChangeCapacity(size_);
+        }
+    }
+
     // Возвращает ссылку на элемент с индексом index
-    Type& operator[](size_t index) noexcept {
+    SIMPLE_VECTOR_CONSTEXPR Type& operator[](size_t index) noexcept {
         assert(index < size_);
         return arr_[index];
     }
 
     // Возвращает константную ссылку на элемент с индексом index
-    const Type& operator[](size_t index) const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR const Type& operator[](size_t index) const noexcept {
         assert(index < size_);
         return arr_[index];
     }
 
     // Возвращает константную ссылку на элемент с индексом index
     // Выбрасывает исключение std::out_of_range, если index >= size
-    Type& At(size_t index) {
+    SIMPLE_VECTOR_CONSTEXPR Type& At(size_t index) {
         if(index >= size_){
             throw std::out_of_range("index >= size");
         }
@@ -268,110 +496,332 @@ public:
 
     // Возвращает константную ссылку на элемент с индексом index
     // Выбрасывает исключение std::out_of_range, если index >= size
-    const Type& At(size_t index) const {
+    SIMPLE_VECTOR_CONSTEXPR const Type& At(size_t index) const {
         if(index >= size_){
             throw std::out_of_range("index >= size");
         }
         return arr_[index];
     }
 
-    // Обнуляет размер массива, не изменяя его вместимость
-    void Clear() noexcept {
+    // Разрушает все элементы, не изменяя вместимость массива
+    SIMPLE_VECTOR_CONSTEXPR void Clear() noexcept {
+        detail::Destroy(GetAlloc(), begin(), end());
         size_ = 0;
     }
 
     // Изменяет размер массива.
-    // При увеличении размера новые элементы получают значение по умолчанию для типа Type
-    void Resize(size_t new_size) {
-        if(new_size <= size_){
-            size_ = new_size;
-        } else if (new_size <= capacity_) {
-            FillDefVal(&arr_[size_], &arr_[new_size]);
-            size_ = new_size;
-        } else {
-            ArrayPtr<Type> tmp(new_size);
-            std::move( arr_.Get(), arr_.Get() + size_, tmp.Get() );
-            FillDefVal(&tmp[size_], &tmp[new_size]);
-            arr_ = std::move(tmp);
-            size_ = new_size;
-            capacity_ = new_size;
-        }
+    // При увеличении размера новые элементы получают значение по умолчанию для типа Type,
+    // при уменьшении лишние элементы разрушаются
+    SIMPLE_VECTOR_CONSTEXPR void Resize(size_t new_size) {
+        ResizeImpl<false>(new_size);
     }
 
-    void FillDefVal(Type* fist, Type* last){
-        for(auto it = fist; it < last; ++it){
-            std::exchange(*it,Type());
-        }
+    // Изменяет размер массива, инициализируя новые элементы по умолчанию (Type x;).
+    // Для тривиальных типов (char, uint8_t, int, POD-структуры) новые элементы
+    // остаются неинициализированными, и рост на N элементов не стоит ни одной записи.
+    // Удобно для буферов, которые сразу перезаписываются read()/recv().
+    // Если аллокатор переопределяет construct, нетривиальные элементы создаются
+    // через construct без аргументов, то есть инициализируются значением
+    SIMPLE_VECTOR_CONSTEXPR void ResizeDefaultInit(size_t new_size) {
+        ResizeImpl<true>(new_size);
+    }
+
+    // То же, что ResizeDefaultInit, но только для тривиальных типов:
+    // гарантирует, что новые элементы не инициализируются
+    SIMPLE_VECTOR_CONSTEXPR void ResizeUninitialized(size_t new_size) {
+        static_assert(std::is_trivially_default_constructible_v<Type> && std::is_trivially_destructible_v<Type>,
+                      "ResizeUninitialized requires a trivial element type");
+        ResizeImpl<true>(new_size);
+    }
+
+    // Добавляет в конец count элементов, инициализированных по умолчанию,
+    // и возвращает итератор на первый из них. Вместимость растёт по политике Growth.
+    // Шаблон для чтения: auto* dst = buf.AppendDefaultInit(n); buf.Resize(old_size + read(fd, dst, n));
+    SIMPLE_VECTOR_CONSTEXPR Iterator AppendDefaultInit(size_t count) {
+        const size_t old_size = size_;
+        ResizeImpl<true>(size_ + count);
+        return begin() + old_size;
     }
 
     // Возвращает итератор на начало массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    Iterator begin() noexcept {
+    SIMPLE_VECTOR_CONSTEXPR Iterator begin() noexcept {
         return arr_.Get();
     }
 
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    Iterator end() noexcept {
+    SIMPLE_VECTOR_CONSTEXPR Iterator end() noexcept {
         return arr_.Get() + size_;
     }
 
     // Возвращает константный итератор на начало массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator begin() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator begin() const noexcept {
         return arr_.Get();
     }
 
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator end() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator end() const noexcept {
         return arr_.Get() + size_;
     }
 
+    // Возвращает указатель на начало данных, сообщая компилятору,
+    // что он выровнен по kAlignment. Вектор не должен быть пустым
+    Type* AlignedData() noexcept {
+        assert(IsAligned());
+        return AssumeAligned(arr_.Get());
+    }
+
+    const Type* AlignedData() const noexcept {
+        assert(IsAligned());
+        return AssumeAligned(arr_.Get());
+    }
+
+    // Сообщает, выровнено ли начало данных по alignment байт
+    bool IsAligned(size_t alignment = kAlignment) const noexcept {
+        return reinterpret_cast<std::uintptr_t>(arr_.Get()) % alignment == 0;
+    }
+
     // Возвращает константный итератор на начало массива
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator cbegin() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator cbegin() const noexcept {
         return begin();
     }
 
     // Возвращает итератор на элемент, следующий за последним
     // Для пустого массива может быть равен (или не равен) nullptr
-    ConstIterator cend() const noexcept {
+    SIMPLE_VECTOR_CONSTEXPR ConstIterator cend() const noexcept {
         return end();
     }
 private:
-    ArrayPtr<Type> arr_;
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    SIMPLE_VECTOR_CONSTEXPR Alloc& GetAlloc() noexcept {
+        return arr_.GetAllocator();
+    }
+
+    static Type* AssumeAligned(Type* ptr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<Type*>(__builtin_assume_aligned(ptr, kAlignment));
+#else
+        return ptr;
+#endif
+    }
+
+    // Обменивает память и размер вместе с аллокаторами
+    SIMPLE_VECTOR_CONSTEXPR void SwapStorage(SimpleVector& other) noexcept {
+        arr_.swap(other.arr_);
+        std::swap(size_, other.size_);
+    }
+
+    SIMPLE_VECTOR_CONSTEXPR void RecordAllocate() noexcept {
+        if(GetCapacity() != 0){
+            Stats::OnAllocate(GetCapacity(), sizeof(Type));
+        }
+    }
+
+    // Сообщает политике статистики о смене буфера; переносятся size_ элементов
+    SIMPLE_VECTOR_CONSTEXPR void RecordGrowth(size_t old_capacity, size_t new_capacity) noexcept {
+        if(old_capacity == 0){
+            Stats::OnAllocate(new_capacity, sizeof(Type));
+        } else {
+            Stats::OnReallocate(old_capacity, new_capacity, sizeof(Type));
+            if(size_ != 0){
+                Stats::OnRelocate(size_, sizeof(Type));
+            }
+        }
+    }
+
+    // Элементы переносятся memmove; при вычислении во время компиляции - поэлементно
+    static constexpr bool RelocatesBytes() noexcept {
+        return kIsTriviallyRelocatable<Type> && !detail::IsConstantEvaluated();
+    }
+
+    // Вместимость, достаточная для required элементов, по политике роста
+    SIMPLE_VECTOR_CONSTEXPR size_t NextCapacity(size_t required) const noexcept {
+        return Growth::NextCapacity(GetCapacity(), required, sizeof(Type));
+    }
+
+    template <bool kDefaultInit>
+    SIMPLE_VECTOR_CONSTEXPR void ResizeImpl(size_t new_size) {
+        if(new_size <= size_){
+            detail::Destroy(GetAlloc(), begin() + new_size, end());
+            size_ = new_size;
+            return;
+        }
+        if(new_size > GetCapacity()){
+            ChangeCapacity(NextCapacity(new_size));
+        }
+        // при вычислении во время компиляции время жизни элементов должно начаться явно
+        if constexpr (kDefaultInit) {
+            if(!std::is_trivially_default_constructible_v<Type> || detail::IsConstantEvaluated()){
+                detail::UninitializedDefaultConstruct(GetAlloc(), end(), begin() + new_size);
+            }
+        } else {
+            detail::UninitializedConstruct(GetAlloc(), end(), begin() + new_size);
+        }
+        size_ = new_size;
+    }
+
+    // Вставляет count элементов forward-диапазона [first, last) в позицию pos_index
+    template <typename ForwardIt>
+    SIMPLE_VECTOR_CONSTEXPR void InsertForward(size_t pos_index, ForwardIt first, ForwardIt last, size_t count) {
+        Type* pos = begin() + pos_index;
+        Type* old_end = end();
+        if(size_ + count > GetCapacity()){
+            ArrayPtr<Type, Alloc> tmp(NextCapacity(size_ + count), GetAllocator());
+            detail::UninitializedCopy(GetAlloc(), first, last, tmp.Get() + pos_index);
+            try {
+                detail::RelocateWithGap(GetAlloc(), begin(), pos, old_end, tmp.Get(), count);
+            } catch (...) {
+                detail::Destroy(GetAlloc(), tmp.Get() + pos_index, tmp.Get() + pos_index + count);
+                throw;
+            }
+            arr_.swap(tmp);
+            RecordGrowth(tmp.GetSize(), GetCapacity());
+            size_ += count;
+            return;
+        }
+        if(RelocatesBytes()){
+            detail::RelocateBytes(pos, old_end, pos + count);
+            try {
+                detail::UninitializedCopy(GetAlloc(), first, last, pos);
+            } catch (...) {
+                detail::RelocateBytes(pos + count, old_end + count, pos);
+                throw;
+            }
+            size_ += count;
+        } else {
+            const size_t tail = size_ - pos_index;
+            if(tail > count){
+                detail::UninitializedMove(GetAlloc(), old_end - count, old_end, old_end);
+                size_ += count;
+                std::move_backward(pos, old_end - count, old_end);
+                std::copy(first, last, pos);
+            } else {
+                ForwardIt mid = std::next(first, tail);
+                Type* moved_tail = detail::UninitializedCopy(GetAlloc(), mid, last, old_end);
+                try {
+                    detail::UninitializedMove(GetAlloc(), pos, old_end, moved_tail);
+                } catch (...) {
+                    detail::Destroy(GetAlloc(), old_end, moved_tail);
+                    throw;
+                }
+                size_ += count;
+                std::copy(first, mid, pos);
+            }
+        }
+    }
+
+    // Память может расти на месте: элементы переносятся побайтово через Alloc::Reallocate
+    static constexpr bool kCanReallocate = kIsTriviallyRelocatable<Type> && detail::HasReallocate<Alloc>::value;
+
+    // Переносит элементы в память под new_capacity элементов
+    SIMPLE_VECTOR_CONSTEXPR void ChangeCapacity(size_t new_capacity) {
+        const size_t old_capacity = GetCapacity();
+        if constexpr (kCanReallocate) {
+            arr_.Reallocate(new_capacity);
+        } else {
+            ArrayPtr<Type, Alloc> tmp(new_capacity, GetAllocator());
+            detail::Relocate(GetAlloc(), begin(), end(), tmp.Get());
+            arr_.swap(tmp);
+        }
+        RecordGrowth(old_capacity, new_capacity);
+    }
+
+    // Переносит элементы в память под new_capacity элементов, конструируя
+    // на позиции pos_index новый элемент из args.
+    // Новый элемент создаётся до переноса старых: args могут ссылаться на элементы вектора
+    template <typename... Args>
+    SIMPLE_VECTOR_CONSTEXPR void GrowAndEmplace(size_t new_capacity, size_t pos_index, Args&&... args) {
+        const size_t old_capacity = GetCapacity();
+        if constexpr (kCanReallocate) {
+            // Reallocate может освободить старый буфер, на который ссылаются args
+            Type tmp_value(std::forward<Args>(args)...);
+            arr_.Reallocate(new_capacity);
+            detail::RelocateBytes(begin() + pos_index, end(), begin() + pos_index + 1);
+            AllocTraits::construct(GetAlloc(), begin() + pos_index, std::move(tmp_value));
+        } else {
+            ArrayPtr<Type, Alloc> tmp(new_capacity, GetAllocator());
+            AllocTraits::construct(GetAlloc(), tmp.Get() + pos_index, std::forward<Args>(args)...);
+            try {
+                detail::RelocateWithGap(GetAlloc(), begin(), begin() + pos_index, end(), tmp.Get(), 1);
+            } catch (...) {
+                AllocTraits::destroy(GetAlloc(), tmp.Get() + pos_index);
+                throw;
+            }
+            arr_.swap(tmp);
+        }
+        RecordGrowth(old_capacity, new_capacity);
+        ++size_;
+    }
+
+    ArrayPtr<Type, Alloc> arr_;
     size_t size_ = 0;
-    size_t capacity_ = 0;
 };
 
+namespace pmr {
 
+// SimpleVector, выделяющий память через std::pmr::memory_resource
+// (например, monotonic_buffer_resource или unsynchronized_pool_resource)
 template <typename Type>
-inline bool operator==(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return std::equal( lhs.begin(), lhs.end(), rhs.begin(), rhs.end() );
+using SimpleVector = ::SimpleVector<Type, std::pmr::polymorphic_allocator<Type>>;
+
+} // namespace pmr
+
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+SIMPLE_VECTOR_CONSTEXPR inline bool operator==(const SimpleVector<Type, Alloc, Growth, Stats>& lhs, const SimpleVector<Type, Alloc, Growth, Stats>& rhs) {
+    return detail::RangeEqual(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
 }
 
-template <typename Type>
-inline bool operator!=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+SIMPLE_VECTOR_CONSTEXPR inline bool operator!=(const SimpleVector<Type, Alloc, Growth, Stats>& lhs, const SimpleVector<Type, Alloc, Growth, Stats>& rhs) {
     return !(lhs == rhs);
 }
 
-template <typename Type>
-inline bool operator<(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return std::lexicographical_compare( lhs.begin(), lhs.end(), rhs.begin(), rhs.end() );
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+SIMPLE_VECTOR_CONSTEXPR inline bool operator<(const SimpleVector<Type, Alloc, Growth, Stats>& lhs, const SimpleVector<Type, Alloc, Growth, Stats>& rhs) {
+    return detail::RangeLess(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
 }
 
-template <typename Type>
-inline bool operator<=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+SIMPLE_VECTOR_CONSTEXPR inline bool operator<=(const SimpleVector<Type, Alloc, Growth, Stats>& lhs, const SimpleVector<Type, Alloc, Growth, Stats>& rhs) {
     return !(lhs > rhs);
 }
 
-template <typename Type>
-inline bool operator>(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+SIMPLE_VECTOR_CONSTEXPR inline bool operator>(const SimpleVector<Type, Alloc, Growth, Stats>& lhs, const SimpleVector<Type, Alloc, Growth, Stats>& rhs) {
     return rhs < lhs;
 }
 
-template <typename Type>
-inline bool operator>=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Alloc, typename Growth, typename Stats>
+SIMPLE_VECTOR_CONSTEXPR inline bool operator>=(const SimpleVector<Type, Alloc, Growth, Stats>& lhs, const SimpleVector<Type, Alloc, Growth, Stats>& rhs) {
     return !(lhs < rhs);
 }
+
+// Удаляет из вектора все элементы, удовлетворяющие pred, за один линейный проход.
+// Арифметические элементы уплотняются без ветвлений, по возможности блоками AVX2
+// (см. compact_kernels.h). Возвращает количество удалённых элементов
+template <typename Type, typename Alloc, typename Growth, typename Stats, typename Predicate>
+SIMPLE_VECTOR_CONSTEXPR size_t EraseIf(SimpleVector<Type, Alloc, Growth, Stats>& vector, Predicate pred) {
+    Type* new_end = nullptr;
+    if constexpr (std::is_arithmetic_v<Type>) {
+        new_end = detail::RemoveIfArithmetic(vector.begin(), vector.end(), pred);
+    } else {
+        new_end = std::remove_if(vector.begin(), vector.end(), pred);
+    }
+    const size_t removed = vector.end() - new_end;
+    vector.Erase(new_end, vector.end());
+    return removed;
+}
+
+// Удаляет из вектора все элементы, равные value.
+// Возвращает количество удалённых элементов
+template <typename Type, typename Alloc, typename Growth, typename Stats, typename Value>
+SIMPLE_VECTOR_CONSTEXPR size_t Erase(SimpleVector<Type, Alloc, Growth, Stats>& vector, const Value& value) {
+    return EraseIf(vector, [&value](const Type& item) {
+        return item == value;
+    });
+}
@@ -0,0 +1,152 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "compare_kernels.h"
+#include "simple_vector.h"
+
+// Невладеющее представление непрерывного участка элементов: указатель и длина.
+// Копируется и нарезается без выделения памяти, поэтому подходит для раздачи
+// частей большого вектора обработчикам. SimpleVectorView<const Type> только читает,
+// SimpleVectorView<Type> может менять элементы, но не размер исходного вектора.
+// Представление действительно, пока исходная память не перераспределена
+template <typename Type>
+class SimpleVectorView {
+    using Value = std::remove_const_t<Type>;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    // Значение count, означающее "до конца представления"
+    static constexpr size_t kToEnd = static_cast<size_t>(-1);
+
+    SimpleVectorView() noexcept = default;
+
+    SimpleVectorView(Type* data, size_t size) noexcept
+        :data_(data)
+        ,size_(size)
+    {
+    }
+
+    // Неявное представление всего вектора
+    template <typename Alloc, typename Growth, typename Stats>
+    SimpleVectorView(SimpleVector<Value, Alloc, Growth, Stats>& vector) noexcept
+        :data_(vector.begin())
+        ,size_(vector.GetSize())
+    {
+    }
+
+    template <typename Alloc, typename Growth, typename Stats, typename Self = Type,
+              typename = std::enable_if_t<std::is_const_v<Self>>>
+    SimpleVectorView(const SimpleVector<Value, Alloc, Growth, Stats>& vector) noexcept
+        :data_(vector.begin())
+        ,size_(vector.GetSize())
+    {
+    }
+
+    // Представление изменяемых элементов приводится к представлению константных
+    template <typename Other, typename = std::enable_if_t<
+        std::is_const_v<Type> && std::is_same_v<Other, Value>>>
+    SimpleVectorView(const SimpleVectorView<Other>& other) noexcept
+        :data_(other.begin())
+        ,size_(other.GetSize())
+    {
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    Type* Data() const noexcept {
+        return data_;
+    }
+
+    Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) const {
+        if(index >= size_){
+            throw std::out_of_range("index out of range");
+        }
+        return data_[index];
+    }
+
+    // Участок [offset, offset + count); count обрезается по концу представления.
+    // Выбрасывает исключение std::out_of_range, если offset > size
+    SimpleVectorView Subview(size_t offset, size_t count = kToEnd) const {
+        if(offset > size_){
+            throw std::out_of_range("subview offset out of range");
+        }
+        return SimpleVectorView(data_ + offset, std::min(count, size_ - offset));
+    }
+
+    // Первые count элементов; count не должен превышать размер
+    SimpleVectorView First(size_t count) const noexcept {
+        assert(count <= size_);
+        return SimpleVectorView(data_, count);
+    }
+
+    // Последние count элементов; count не должен превышать размер
+    SimpleVectorView Last(size_t count) const noexcept {
+        assert(count <= size_);
+        return SimpleVectorView(data_ + (size_ - count), count);
+    }
+
+    Iterator begin() const noexcept {
+        return data_;
+    }
+
+    Iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+    // Операторы сравнения объявлены друзьями, поэтому вектор слева или справа
+    // неявно приводится к представлению
+    friend bool operator==(const SimpleVectorView& lhs, const SimpleVectorView& rhs) {
+        return detail::RangeEqual<Value>(lhs.data_, lhs.size_, rhs.data_, rhs.size_);
+    }
+
+    friend bool operator!=(const SimpleVectorView& lhs, const SimpleVectorView& rhs) {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator<(const SimpleVectorView& lhs, const SimpleVectorView& rhs) {
+        return detail::RangeLess<Value>(lhs.data_, lhs.size_, rhs.data_, rhs.size_);
+    }
+
+    friend bool operator<=(const SimpleVectorView& lhs, const SimpleVectorView& rhs) {
+        return !(rhs < lhs);
+    }
+
+    friend bool operator>(const SimpleVectorView& lhs, const SimpleVectorView& rhs) {
+        return rhs < lhs;
+    }
+
+    friend bool operator>=(const SimpleVectorView& lhs, const SimpleVectorView& rhs) {
+        return !(lhs < rhs);
+    }
+
+private:
+    Type* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,390 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "array_ptr.h"
+#include "compare_kernels.h"
+#include "growth_policy.h"
+
+// Вектор, хранящий первые N элементов внутри самого объекта.
+// Пока размер не превышает N, память в куче не выделяется; при переполнении
+// элементы переносятся в кучу и дальше вместимость растёт по политике Growth, как у SimpleVector
+template <typename Type, size_t N, typename Growth = DoublingGrowth>
+class SmallSimpleVector {
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    static_assert(N > 0, "inline capacity must be positive");
+
+    SmallSimpleVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit SmallSimpleVector(size_t size) {
+        Reserve(size);
+        detail::UninitializedConstruct(GetAlloc(), begin(), begin() + size);
+        size_ = size;
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    SmallSimpleVector(size_t size, const Type& value) {
+        Reserve(size);
+        detail::UninitializedConstruct(GetAlloc(), begin(), begin() + size, value);
+        size_ = size;
+    }
+
+    // Создаёт вектор из std::initializer_list
+    SmallSimpleVector(std::initializer_list<Type> init) {
+        Reserve(init.size());
+        detail::UninitializedCopy(GetAlloc(), init.begin(), init.end(), begin());
+        size_ = init.size();
+    }
+
+    SmallSimpleVector(const SmallSimpleVector& other) {
+        Reserve(other.GetSize());
+#if defined(__GNUC__) && !defined(__clang__)
+        // GCC принимает указатель end() на свободную часть встроенного буфера other
+        // за чтение неинициализированной памяти
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+        detail::UninitializedCopy(GetAlloc(), other.begin(), other.end(), begin());
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+        size_ = other.GetSize();
+    }
+
+    // Память в куче забирается целиком, встроенные элементы переносятся по одному
+    SmallSimpleVector(SmallSimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        MoveFrom(other);
+    }
+
+    ~SmallSimpleVector() {
+        detail::Destroy(GetAlloc(), begin(), end());
+    }
+
+    SmallSimpleVector& operator=(const SmallSimpleVector& rhs) {
+        if(&rhs != this){
+            SmallSimpleVector tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    SmallSimpleVector& operator=(SmallSimpleVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        if(&rhs != this){
+            Clear();
+            heap_ = ArrayPtr<Type>();
+            MoveFrom(rhs);
+        }
+        return *this;
+    }
+
+    // Добавляет элемент в конец вектора
+    // При нехватке места увеличивает вместимость вектора по политике Growth
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Вставляет значение value в позицию pos.
+    // Возвращает итератор на вставленное значение
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Конструирует элемент из args прямо в конце вектора, без временного объекта.
+    // При нехватке места элемент создаётся сразу в новом буфере.
+    // Возвращает ссылку на созданный элемент
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if(size_ < GetCapacity()){
+            AllocTraits::construct(GetAlloc(), end(), std::forward<Args>(args)...);
+            ++size_;
+        } else {
+            GrowAndEmplace(NextCapacity(), size_, std::forward<Args>(args)...);
+        }
+        return *(end() - 1);
+    }
+
+    // Конструирует элемент из args в позиции pos и возвращает итератор на него.
+    // В конце вектора и при реаллокации элемент создаётся сразу на своём месте.
+    // Если вставка в середину не требует реаллокации, элемент сначала создаётся
+    // во временном объекте: args могут ссылаться на сдвигаемые элементы вектора
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t pos_index = pos - cbegin();
+        if(pos == cend()){
+            EmplaceBack(std::forward<Args>(args)...);
+            return begin() + pos_index;
+        }
+        if(size_ == GetCapacity()){
+            GrowAndEmplace(NextCapacity(), pos_index, std::forward<Args>(args)...);
+            return begin() + pos_index;
+        }
+        Type tmp_value(std::forward<Args>(args)...);
+        if constexpr (kIsTriviallyRelocatable<Type>) {
+            detail::RelocateBytes(begin() + pos_index, end(), begin() + pos_index + 1);
+            try {
+                AllocTraits::construct(GetAlloc(), begin() + pos_index, std::move(tmp_value));
+            } catch (...) {
+                detail::RelocateBytes(begin() + pos_index + 1, end() + 1, begin() + pos_index);
+                throw;
+            }
+            ++size_;
+        } else {
+            AllocTraits::construct(GetAlloc(), end(), std::move(*(end() - 1)));
+            ++size_;
+            std::move_backward(begin() + pos_index, end() - 2, end() - 1);
+            begin()[pos_index] = std::move(tmp_value);
+        }
+        return begin() + pos_index;
+    }
+
+    // Удаляет последний элемент вектора. Вектор не должен быть пустым
+    void PopBack() noexcept {
+        assert(!IsEmpty());
+        AllocTraits::destroy(GetAlloc(), end() - 1);
+        --size_;
+    }
+
+    // Удаляет элемент вектора в указанной позиции
+    Iterator Erase(ConstIterator pos) {
+        assert(pos >= cbegin() && pos < cend());
+        Iterator tmp_pos = const_cast<Iterator>(pos);
+        if constexpr (kIsTriviallyRelocatable<Type>) {
+            AllocTraits::destroy(GetAlloc(), tmp_pos);
+            detail::RelocateBytes(tmp_pos + 1, end(), tmp_pos);
+            --size_;
+        } else {
+            std::move(tmp_pos + 1, end(), tmp_pos);
+            PopBack();
+        }
+        return tmp_pos;
+    }
+
+    // Обменивает значение с другим вектором
+    void swap(SmallSimpleVector& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        if(!IsInline() && !other.IsInline()){
+            heap_.swap(other.heap_);
+            std::swap(size_, other.size_);
+            return;
+        }
+        SmallSimpleVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    // Возвращает количество элементов в массиве
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает вместимость массива
+    size_t GetCapacity() const noexcept {
+        return IsInline() ? N : heap_.GetSize();
+    }
+
+    // Сообщает, пустой ли массив
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Сообщает, хранятся ли элементы внутри объекта
+    bool IsInline() const noexcept {
+        return !heap_;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if(new_capacity > GetCapacity()){
+            GrowTo(new_capacity);
+        }
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return begin()[index];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return begin()[index];
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if(index >= size_){
+            throw std::out_of_range("index >= size");
+        }
+        return begin()[index];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    const Type& At(size_t index) const {
+        if(index >= size_){
+            throw std::out_of_range("index >= size");
+        }
+        return begin()[index];
+    }
+
+    // Разрушает все элементы, не изменяя вместимость массива
+    void Clear() noexcept {
+        detail::Destroy(GetAlloc(), begin(), end());
+        size_ = 0;
+    }
+
+    // Изменяет размер массива.
+    // При увеличении размера новые элементы получают значение по умолчанию для типа Type,
+    // при уменьшении лишние элементы разрушаются
+    void Resize(size_t new_size) {
+        if(new_size <= size_){
+            detail::Destroy(GetAlloc(), begin() + new_size, end());
+        } else {
+            if(new_size > GetCapacity()){
+                GrowTo(Growth::NextCapacity(GetCapacity(), new_size, sizeof(Type)));
+            }
+            detail::UninitializedConstruct(GetAlloc(), end(), begin() + new_size);
+        }
+        size_ = new_size;
+    }
+
+    Iterator begin() noexcept {
+        return IsInline() ? InlineData() : heap_.Get();
+    }
+
+    Iterator end() noexcept {
+        return begin() + size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return IsInline() ? InlineData() : heap_.Get();
+    }
+
+    ConstIterator end() const noexcept {
+        return begin() + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<std::allocator<Type>>;
+
+    std::allocator<Type>& GetAlloc() noexcept {
+        return heap_.GetAllocator();
+    }
+
+    Type* InlineData() noexcept {
+        return reinterpret_cast<Type*>(inline_);
+    }
+
+    const Type* InlineData() const noexcept {
+        return reinterpret_cast<const Type*>(inline_);
+    }
+
+    // Забирает элементы other; сам вектор должен быть пуст и храниться внутри объекта
+    void MoveFrom(SmallSimpleVector& other) {
+        if(other.IsInline()){
+#if defined(__GNUC__) || defined(__clang__)
+            // встроенных элементов не больше N; без подсказки GCC предупреждает о выходе за буфер
+            if(other.size_ > N){
+                __builtin_unreachable();
+            }
+#endif
+            detail::Relocate(GetAlloc(), other.begin(), other.end(), InlineData());
+        } else {
+            heap_ = std::move(other.heap_);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // Вместимость для ещё одного элемента при заполненном буфере
+    size_t NextCapacity() const noexcept {
+        return Growth::NextCapacity(GetCapacity(), size_ + 1, sizeof(Type));
+    }
+
+    // Переносит элементы в кучу под new_capacity элементов
+    void GrowTo(size_t new_capacity) {
+        ArrayPtr<Type> tmp(new_capacity);
+        detail::Relocate(GetAlloc(), begin(), end(), tmp.Get());
+        heap_ = std::move(tmp);
+    }
+
+    // Переносит элементы в кучу, конструируя на позиции pos_index новый элемент из args.
+    // Новый элемент создаётся до переноса старых: args могут ссылаться на элементы вектора
+    template <typename... Args>
+    void GrowAndEmplace(size_t new_capacity, size_t pos_index, Args&&... args) {
+        // Границы берутся до конструирования: запись в tmp не может изменить размер,
+        // но компилятор этого не знает и перечитывает size_
+        Type* const first = begin();
+        Type* const last = first + size_;
+        ArrayPtr<Type> tmp(new_capacity);
+        AllocTraits::construct(GetAlloc(), tmp.Get() + pos_index, std::forward<Args>(args)...);
+        try {
+            detail::RelocateWithGap(GetAlloc(), first, first + pos_index, last, tmp.Get(), 1);
+        } catch (...) {
+            AllocTraits::destroy(GetAlloc(), tmp.Get() + pos_index);
+            throw;
+        }
+        heap_ = std::move(tmp);
+        ++size_;
+    }
+
+    // Пуст, пока элементы хранятся внутри объекта
+    ArrayPtr<Type> heap_;
+    size_t size_ = 0;
+    alignas(Type) unsigned char inline_[N * sizeof(Type)];
+};
+
+template <typename Type, size_t N, typename Growth>
+inline bool operator==(const SmallSimpleVector<Type, N, Growth>& lhs, const SmallSimpleVector<Type, N, Growth>& rhs) {
+    return detail::RangeEqual(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
+}
+
+template <typename Type, size_t N, typename Growth>
+inline bool operator!=(const SmallSimpleVector<Type, N, Growth>& lhs, const SmallSimpleVector<Type, N, Growth>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t N, typename Growth>
+inline bool operator<(const SmallSimpleVector<Type, N, Growth>& lhs, const SmallSimpleVector<Type, N, Growth>& rhs) {
+    return detail::RangeLess(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
+}
+
+template <typename Type, size_t N, typename Growth>
+inline bool operator<=(const SmallSimpleVector<Type, N, Growth>& lhs, const SmallSimpleVector<Type, N, Growth>& rhs) {
+    return !(lhs > rhs);
+}
+
+template <typename Type, size_t N, typename Growth>
+inline bool operator>(const SmallSimpleVector<Type, N, Growth>& lhs, const SmallSimpleVector<Type, N, Growth>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, size_t N, typename Growth>
+inline bool operator>=(const SmallSimpleVector<Type, N, Growth>& lhs, const SmallSimpleVector<Type, N, Growth>& rhs) {
+    return !(lhs < rhs);
+}
@@ -0,0 +1,280 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "simple_vector.h"
+#include "simple_vector_view.h"
+
+// Таблица "структура массивов": по одному непрерывному столбцу SimpleVector на поле.
+// Все столбцы растут вместе и всегда одной длины. Строка доступна как кортеж ссылок
+// на поля, а столбец - как SimpleVectorView, так что проход по одному полю читает
+// только его байты и векторизуется, как обход обычного массива
+template <typename... Fields>
+class SoAVector {
+    template <bool kConst>
+    class BasicIterator;
+
+public:
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+
+    // Кортеж ссылок на поля строки
+    using Row = std::tuple<Fields&...>;
+    using ConstRow = std::tuple<const Fields&...>;
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    template <size_t kIndex>
+    using Field = std::tuple_element_t<kIndex, std::tuple<Fields...>>;
+
+    SoAVector() noexcept = default;
+
+    // Создаёт таблицу из size строк, поля которых инициализированы значением по умолчанию
+    explicit SoAVector(size_t size)
+        :columns_(SimpleVector<Fields>(size)...)
+    {
+    }
+
+    // Добавляет строку из значений полей. Если конструирование какого-то поля
+    // бросило исключение, уже добавленные поля удаляются и таблица не меняется
+    template <typename... Args, typename = std::enable_if_t<sizeof...(Args) == sizeof...(Fields)>>
+    void PushBack(Args&&... args) {
+        PushBackImpl(std::index_sequence_for<Fields...>{}, std::forward<Args>(args)...);
+    }
+
+    // "Удаляет" последнюю строку. Таблица не должна быть пустой
+    void PopBack() noexcept {
+        assert(!IsEmpty());
+        ForEachColumn([](auto& column) {
+            column.PopBack();
+        });
+    }
+
+    // Удаляет строку с номером index, сдвигая следующие строки
+    void Erase(size_t index) {
+        assert(index < GetSize());
+        ForEachColumn([index](auto& column) {
+            column.Erase(column.begin() + index);
+        });
+    }
+
+    // Возвращает количество строк
+    size_t GetSize() const noexcept {
+        return std::get<0>(columns_).GetSize();
+    }
+
+    // Возвращает вместимость: наименьшую из вместимостей столбцов
+    size_t GetCapacity() const noexcept {
+        return std::apply([](const auto&... column) {
+            return std::min({column.GetCapacity()...});
+        }, columns_);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Резервирует место под new_capacity строк во всех столбцах
+    void Reserve(size_t new_capacity) {
+        ForEachColumn([new_capacity](auto& column) {
+            column.Reserve(new_capacity);
+        });
+    }
+
+    // Изменяет число строк; новые поля инициализируются значением по умолчанию.
+    // Если конструирование поля бросило исключение, все столбцы возвращаются к прежней длине
+    void Resize(size_t new_size) {
+        const size_t old_size = GetSize();
+        Reserve(new_size);
+        try {
+            ForEachColumn([new_size](auto& column) {
+                column.Resize(new_size);
+            });
+        } catch (...) {
+            ForEachColumn([old_size](auto& column) {
+                if(column.GetSize() > old_size){
+                    column.Resize(old_size);
+                }
+            });
+            throw;
+        }
+    }
+
+    void Clear() noexcept {
+        ForEachColumn([](auto& column) {
+            column.Clear();
+        });
+    }
+
+    void swap(SoAVector& other) noexcept {
+        columns_.swap(other.columns_);
+    }
+
+    // Возвращает кортеж ссылок на поля строки index
+    Row operator[](size_t index) noexcept {
+        assert(index < GetSize());
+        return std::apply([index](auto&... column) {
+            return Row(column[index]...);
+        }, columns_);
+    }
+
+    ConstRow operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return std::apply([index](const auto&... column) {
+            return ConstRow(column[index]...);
+        }, columns_);
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Row At(size_t index) {
+        if(index >= GetSize()){
+            throw std::out_of_range("index out of range");
+        }
+        return (*this)[index];
+    }
+
+    ConstRow At(size_t index) const {
+        if(index >= GetSize()){
+            throw std::out_of_range("index out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Непрерывный столбец поля kIndex
+    template <size_t kIndex>
+    SimpleVectorView<Field<kIndex>> Column() noexcept {
+        return std::get<kIndex>(columns_);
+    }
+
+    template <size_t kIndex>
+    SimpleVectorView<const Field<kIndex>> Column() const noexcept {
+        return std::get<kIndex>(columns_);
+    }
+
+    Iterator begin() noexcept {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept {
+        return Iterator(this, GetSize());
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, GetSize());
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    friend bool operator==(const SoAVector& lhs, const SoAVector& rhs) {
+        return lhs.columns_ == rhs.columns_;
+    }
+
+    friend bool operator!=(const SoAVector& lhs, const SoAVector& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    // Итератор по строкам; разыменование даёт кортеж ссылок, а не ссылку,
+    // поэтому он формально только входной, хотя поддерживает арифметику
+    template <bool kConst>
+    class BasicIterator {
+        using Owner = std::conditional_t<kConst, const SoAVector, SoAVector>;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<kConst, ConstRow, Row>;
+        using pointer = void;
+
+        BasicIterator() noexcept = default;
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        reference operator[](difference_type offset) const noexcept {
+            return (*owner_)[index_ + offset];
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator tmp = *this;
+            ++index_;
+            return tmp;
+        }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept {
+            return it += offset;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+    private:
+        friend class SoAVector;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+            :owner_(owner)
+            ,index_(index)
+        {
+        }
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    template <typename Func>
+    void ForEachColumn(Func func) {
+        std::apply([&func](auto&... column) {
+            (func(column), ...);
+        }, columns_);
+    }
+
+    template <size_t... kIndices, typename... Args>
+    void PushBackImpl(std::index_sequence<kIndices...>, Args&&... args) {
+        size_t pushed = 0;
+        try {
+            ((std::get<kIndices>(columns_).EmplaceBack(std::forward<Args>(args)), ++pushed), ...);
+        } catch (...) {
+            ((kIndices < pushed ? std::get<kIndices>(columns_).PopBack() : void()), ...);
+            throw;
+        }
+    }
+
+    std::tuple<SimpleVector<Fields>...> columns_;
+};
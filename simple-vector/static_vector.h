@@ -0,0 +1,405 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "array_ptr.h"
+#include "compare_kernels.h"
+
+namespace detail {
+
+// Встроенная память StaticVector. Для тривиально копируемых Type все специальные
+// функции по умолчанию, и сам вектор тривиально копируем: его можно копировать memcpy,
+// класть в разделяемую память и передавать по сети как есть
+template <typename Type, size_t N, bool = std::is_trivially_copyable_v<Type>>
+struct StaticStorage {
+    static std::allocator<Type>& GetAlloc() noexcept {
+        static std::allocator<Type> alloc;
+        return alloc;
+    }
+
+    Type* Data() noexcept {
+        return std::launder(reinterpret_cast<Type*>(bytes_));
+    }
+
+    const Type* Data() const noexcept {
+        return std::launder(reinterpret_cast<const Type*>(bytes_));
+    }
+
+    size_t size_ = 0;
+    alignas(Type) unsigned char bytes_[N * sizeof(Type)];
+};
+
+// Нетривиальные элементы копируются, перемещаются и разрушаются по одному
+template <typename Type, size_t N>
+struct StaticStorage<Type, N, false> : StaticStorage<Type, N, true> {
+    using Base = StaticStorage<Type, N, true>;
+
+    StaticStorage() noexcept = default;
+
+    StaticStorage(const StaticStorage& other) {
+        UninitializedCopy(Base::GetAlloc(), other.Data(), other.Data() + other.size_, this->Data());
+        this->size_ = other.size_;
+    }
+
+    StaticStorage(StaticStorage&& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        UninitializedMove(Base::GetAlloc(), other.Data(), other.Data() + other.size_, this->Data());
+        this->size_ = other.size_;
+    }
+
+    ~StaticStorage() {
+        Destroy(Base::GetAlloc(), this->Data(), this->Data() + this->size_);
+    }
+
+    StaticStorage& operator=(const StaticStorage& rhs) {
+        if(this != &rhs){
+            Assign(rhs.Data(), rhs.size_, [](const Type& item) -> const Type& {
+                return item;
+            });
+        }
+        return *this;
+    }
+
+    StaticStorage& operator=(StaticStorage&& rhs) noexcept(std::is_nothrow_move_constructible_v<Type>
+                                                           && std::is_nothrow_move_assignable_v<Type>) {
+        if(this != &rhs){
+            Assign(rhs.Data(), rhs.size_, [](Type& item) -> Type&& {
+                return std::move(item);
+            });
+        }
+        return *this;
+    }
+
+private:
+    // Общая часть присваиваний: присваивает совпадающий префикс,
+    // остальное конструирует или разрушает
+    template <typename Source, typename Cast>
+    void Assign(Source* source, size_t size, Cast cast) {
+        Type* data = this->Data();
+        const size_t common = std::min(this->size_, size);
+        for(size_t i = 0; i < common; ++i){
+            data[i] = cast(source[i]);
+        }
+        if(size < this->size_){
+            Destroy(Base::GetAlloc(), data + size, data + this->size_);
+            this->size_ = size;
+        }
+        for(; this->size_ < size; ++this->size_){
+            std::allocator_traits<std::allocator<Type>>::construct(Base::GetAlloc(), data + this->size_,
+                                                                   cast(source[this->size_]));
+        }
+    }
+};
+
+} // namespace detail
+
+// Вектор фиксированной вместимости N, все элементы хранятся внутри объекта.
+// Память в куче не выделяется никогда, обращение к элементам не проходит через указатель.
+// Интерфейс как у SimpleVector; переполнение - исключение std::length_error
+// у PushBack/Insert/Resize или false у TryPushBack
+template <typename Type, size_t N>
+class StaticVector : private detail::StaticStorage<Type, N> {
+    using Storage = detail::StaticStorage<Type, N>;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    static_assert(N > 0, "capacity must be positive");
+
+    StaticVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit StaticVector(size_t size) {
+        Resize(size);
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    StaticVector(size_t size, const Type& value) {
+        Resize(size, value);
+    }
+
+    // Создаёт вектор из std::initializer_list
+    StaticVector(std::initializer_list<Type> init) {
+        CheckCapacity(init.size());
+        detail::UninitializedCopy(GetAlloc(), init.begin(), init.end(), begin());
+        this->size_ = init.size();
+    }
+
+    // Добавляет элемент в конец вектора
+    // Выбрасывает исключение std::length_error, если вектор заполнен
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Добавляет элемент, если есть место. Возвращает false, если вектор заполнен
+    [[nodiscard]] bool TryPushBack(const Type& item) {
+        return TryEmplaceBack(item) != nullptr;
+    }
+
+    [[nodiscard]] bool TryPushBack(Type&& item) {
+        return TryEmplaceBack(std::move(item)) != nullptr;
+    }
+
+    // Конструирует элемент из args в конце вектора и возвращает ссылку на него
+    // Выбрасывает исключение std::length_error, если вектор заполнен
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        CheckCapacity(this->size_ + 1);
+        return *TryEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // Конструирует элемент из args в конце вектора, если есть место.
+    // Возвращает указатель на него или nullptr, если вектор заполнен
+    template <typename... Args>
+    Type* TryEmplaceBack(Args&&... args) {
+        if(IsFull()){
+            return nullptr;
+        }
+        Type* slot = end();
+        AllocTraits::construct(GetAlloc(), slot, std::forward<Args>(args)...);
+        ++this->size_;
+        return slot;
+    }
+
+    // Вставляет значение value в позицию pos.
+    // Возвращает итератор на вставленное значение
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Конструирует элемент из args в позиции pos и возвращает итератор на него.
+    // Элемент сначала создаётся во временном объекте: args могут ссылаться на сдвигаемые элементы
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        assert(pos >= cbegin() && pos <= cend());
+        const size_t pos_index = pos - cbegin();
+        CheckCapacity(this->size_ + 1);
+        if(pos == cend()){
+            EmplaceBack(std::forward<Args>(args)...);
+            return begin() + pos_index;
+        }
+        Type tmp_value(std::forward<Args>(args)...);
+        if constexpr (kIsTriviallyRelocatable<Type>) {
+            detail::RelocateBytes(begin() + pos_index, end(), begin() + pos_index + 1);
+            try {
+                AllocTraits::construct(GetAlloc(), begin() + pos_index, std::move(tmp_value));
+            } catch (...) {
+                detail::RelocateBytes(begin() + pos_index + 1, end() + 1, begin() + pos_index);
+                throw;
+            }
+            ++this->size_;
+        } else {
+            AllocTraits::construct(GetAlloc(), end(), std::move(*(end() - 1)));
+            ++this->size_;
+            std::move_backward(begin() + pos_index, end() - 2, end() - 1);
+            begin()[pos_index] = std::move(tmp_value);
+        }
+        return begin() + pos_index;
+    }
+
+    // "Удаляет" последний элемент вектора. Вектор не должен быть пустым
+    void PopBack() noexcept {
+        assert(!IsEmpty());
+        AllocTraits::destroy(GetAlloc(), end() - 1);
+        --this->size_;
+    }
+
+    // Удаляет элемент вектора в указанной позиции
+    Iterator Erase(ConstIterator pos) {
+        assert(pos >= cbegin() && pos < cend());
+        return Erase(pos, pos + 1);
+    }
+
+    // Удаляет элементы [first, last), сдвигая хвост один раз.
+    // Возвращает итератор на элемент, следовавший за удалёнными
+    Iterator Erase(ConstIterator first, ConstIterator last) {
+        assert(first >= cbegin() && first <= last && last <= cend());
+        Iterator tmp_first = const_cast<Iterator>(first);
+        Iterator tmp_last = const_cast<Iterator>(last);
+        const size_t count = tmp_last - tmp_first;
+        if constexpr (kIsTriviallyRelocatable<Type>) {
+            detail::Destroy(GetAlloc(), tmp_first, tmp_last);
+            detail::RelocateBytes(tmp_last, end(), tmp_first);
+        } else {
+            std::move(tmp_last, end(), tmp_first);
+            detail::Destroy(GetAlloc(), end() - count, end());
+        }
+        this->size_ -= count;
+        return tmp_first;
+    }
+
+    // Обменивает значение с другим вектором поэлементно
+    void swap(StaticVector& other) noexcept(std::is_nothrow_move_constructible_v<Type>
+                                            && std::is_nothrow_swappable_v<Type>) {
+        if(this == &other){
+            return;
+        }
+        StaticVector& shorter = GetSize() < other.GetSize() ? *this : other;
+        StaticVector& longer = GetSize() < other.GetSize() ? other : *this;
+        std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+        const size_t common = shorter.GetSize();
+        detail::UninitializedMove(GetAlloc(), longer.begin() + common, longer.end(), shorter.end());
+        detail::Destroy(GetAlloc(), longer.begin() + common, longer.end());
+        shorter.size_ = longer.size_;
+        longer.size_ = common;
+    }
+
+    // Возвращает количество элементов в массиве
+    size_t GetSize() const noexcept {
+        return this->size_;
+    }
+
+    // Возвращает вместимость массива
+    static constexpr size_t GetCapacity() noexcept {
+        return N;
+    }
+
+    // Сообщает, пустой ли массив
+    bool IsEmpty() const noexcept {
+        return this->size_ == 0;
+    }
+
+    // Сообщает, заполнен ли массив
+    bool IsFull() const noexcept {
+        return this->size_ == N;
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        assert(index < this->size_);
+        return begin()[index];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < this->size_);
+        return begin()[index];
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if(index >= this->size_){
+            throw std::out_of_range("index >= size");
+        }
+        return begin()[index];
+    }
+
+    // Возвращает константную ссылку на элемент с индексом index
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    const Type& At(size_t index) const {
+        if(index >= this->size_){
+            throw std::out_of_range("index >= size");
+        }
+        return begin()[index];
+    }
+
+    // Разрушает все элементы
+    void Clear() noexcept {
+        detail::Destroy(GetAlloc(), begin(), end());
+        this->size_ = 0;
+    }
+
+    // Изменяет размер массива.
+    // При увеличении размера новые элементы получают значение по умолчанию для типа Type,
+    // при уменьшении лишние элементы разрушаются.
+    // Выбрасывает исключение std::length_error, если new_size > N
+    void Resize(size_t new_size) {
+        ResizeImpl(new_size);
+    }
+
+    void Resize(size_t new_size, const Type& value) {
+        ResizeImpl(new_size, value);
+    }
+
+    Iterator begin() noexcept {
+        return this->Data();
+    }
+
+    Iterator end() noexcept {
+        return begin() + this->size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return this->Data();
+    }
+
+    ConstIterator end() const noexcept {
+        return begin() + this->size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<std::allocator<Type>>;
+    using Storage::GetAlloc;
+
+    static void CheckCapacity(size_t required) {
+        if(required > N){
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+
+    template <typename... Args>
+    void ResizeImpl(size_t new_size, const Args&... args) {
+        CheckCapacity(new_size);
+        if(new_size <= this->size_){
+            detail::Destroy(GetAlloc(), begin() + new_size, end());
+        } else {
+            detail::UninitializedConstruct(GetAlloc(), end(), begin() + new_size, args...);
+        }
+        this->size_ = new_size;
+    }
+};
+
+template <typename Type, size_t N>
+inline bool operator==(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return detail::RangeEqual(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
+}
+
+template <typename Type, size_t N>
+inline bool operator!=(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t N>
+inline bool operator<(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return detail::RangeLess(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
+}
+
+template <typename Type, size_t N>
+inline bool operator<=(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return !(lhs > rhs);
+}
+
+template <typename Type, size_t N>
+inline bool operator>(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, size_t N>
+inline bool operator>=(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return !(lhs < rhs);
+}
@@ -0,0 +1,188 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+// Политики статистики SimpleVector: четвёртый параметр шаблона.
+// Вектор сообщает политике о событиях своей памяти:
+//   OnAllocate(capacity, element_size)                 - выделен первый буфер
+//   OnReallocate(old_capacity, new_capacity, element_size) - буфер заменён или изменён
+//   OnRelocate(count, element_size)                    - элементы перенесены при росте
+//   OnCopy(count, element_size)                        - элементы скопированы при копировании вектора
+//   OnRelease(size, capacity, element_size)            - вектор с буфером разрушен
+// Все методы статические, так что политика не увеличивает размер вектора
+
+// Статистика выключена: пустые встраиваемые функции, компилятор убирает вызовы целиком
+struct NoStats {
+    static constexpr void OnAllocate(size_t, size_t) noexcept {
+    }
+
+    static constexpr void OnReallocate(size_t, size_t, size_t) noexcept {
+    }
+
+    static constexpr void OnRelocate(size_t, size_t) noexcept {
+    }
+
+    static constexpr void OnCopy(size_t, size_t) noexcept {
+    }
+
+    static constexpr void OnRelease(size_t, size_t, size_t) noexcept {
+    }
+};
+
+// Счётчики одного места вызова. Обновляются атомарно без упорядочивания:
+// векторы с одним тегом могут жить в разных потоках
+struct StatsCounters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> reallocations{0};
+    std::atomic<uint64_t> elements_relocated{0};
+    std::atomic<uint64_t> bytes_relocated{0};
+    std::atomic<uint64_t> elements_copied{0};
+    std::atomic<uint64_t> bytes_copied{0};
+    std::atomic<uint64_t> peak_capacity{0};
+    std::atomic<uint64_t> releases{0};
+    // Суммы размеров и вместимостей разрушенных векторов: их отношение - средняя заполненность
+    std::atomic<uint64_t> released_size{0};
+    std::atomic<uint64_t> released_capacity{0};
+
+    void UpdatePeak(uint64_t capacity) noexcept {
+        uint64_t peak = peak_capacity.load(std::memory_order_relaxed);
+        while(capacity > peak && !peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)){
+        }
+    }
+};
+
+// Реестр счётчиков всех тегов процесса
+class StatsRegistry {
+public:
+    // Реестр не разрушается: векторы со статистикой могут жить в статических
+    // объектах и обращаться к счётчикам при завершении программы
+    static StatsRegistry& Instance() {
+        static StatsRegistry* instance = new StatsRegistry();
+        return *instance;
+    }
+
+    // Регистрирует счётчики тега name; они должны жить до конца программы
+    void Add(const char* name, const StatsCounters& counters) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push_back({name, &counters});
+    }
+
+    // Вызывает func(name, counters) для каждого зарегистрированного тега
+    template <typename Func>
+    void ForEach(Func func) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(const auto& entry : entries_){
+            func(entry.name, *entry.counters);
+        }
+    }
+
+    // Печатает отчёт: по строке на тег
+    void Dump(std::ostream& out) const {
+        out << "SimpleVector stats: tag allocations reallocations relocated(elements/bytes) "
+               "copied(elements/bytes) peak_capacity releases fill%\n";
+        ForEach([&out](const char* name, const StatsCounters& counters) {
+            const uint64_t released_capacity = counters.released_capacity.load(std::memory_order_relaxed);
+            const uint64_t fill = released_capacity == 0 ? 100
+                : counters.released_size.load(std::memory_order_relaxed) * 100 / released_capacity;
+            out << name
+                << ' ' << counters.allocations.load(std::memory_order_relaxed)
+                << ' ' << counters.reallocations.load(std::memory_order_relaxed)
+                << ' ' << counters.elements_relocated.load(std::memory_order_relaxed)
+                << '/' << counters.bytes_relocated.load(std::memory_order_relaxed)
+                << ' ' << counters.elements_copied.load(std::memory_order_relaxed)
+                << '/' << counters.bytes_copied.load(std::memory_order_relaxed)
+                << ' ' << counters.peak_capacity.load(std::memory_order_relaxed)
+                << ' ' << counters.releases.load(std::memory_order_relaxed)
+                << ' ' << fill << '\n';
+        });
+    }
+
+private:
+    struct Entry {
+        const char* name = nullptr;
+        const StatsCounters* counters = nullptr;
+    };
+
+    StatsRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;
+};
+
+namespace detail {
+
+template <typename Tag, typename = void>
+struct StatsTagName {
+    static const char* Get() noexcept {
+        return typeid(Tag).name();
+    }
+};
+
+template <typename Tag>
+struct StatsTagName<Tag, std::void_t<decltype(Tag::kName)>> {
+    static const char* Get() noexcept {
+        return Tag::kName;
+    }
+};
+
+} // namespace detail
+
+// Статистика включена. Tag - пустой тип, различающий места вызова;
+// имя в отчёте берётся из Tag::kName, если он объявлен, иначе из typeid:
+//   struct ParserTokens { static constexpr const char* kName = "parser tokens"; };
+//   SimpleVector<Token, std::allocator<Token>, DoublingGrowth, CountingStats<ParserTokens>> tokens;
+// Счётчики - статический объект без динамической инициализации, поэтому хуки
+// не выделяют память и не берут мьютекс. Тег попадает в реестр при инициализации
+// статических объектов программы, а не при первом событии вектора
+template <typename Tag>
+struct CountingStats {
+    static StatsCounters& Counters() noexcept {
+        static_cast<void>(registered_);
+        static StatsCounters counters;
+        return counters;
+    }
+
+    static void OnAllocate(size_t capacity, size_t) noexcept {
+        StatsCounters& counters = Counters();
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.UpdatePeak(capacity);
+    }
+
+    static void OnReallocate(size_t, size_t new_capacity, size_t) noexcept {
+        StatsCounters& counters = Counters();
+        counters.reallocations.fetch_add(1, std::memory_order_relaxed);
+        counters.UpdatePeak(new_capacity);
+    }
+
+    static void OnRelocate(size_t count, size_t element_size) noexcept {
+        StatsCounters& counters = Counters();
+        counters.elements_relocated.fetch_add(count, std::memory_order_relaxed);
+        counters.bytes_relocated.fetch_add(count * element_size, std::memory_order_relaxed);
+    }
+
+    static void OnCopy(size_t count, size_t element_size) noexcept {
+        StatsCounters& counters = Counters();
+        counters.elements_copied.fetch_add(count, std::memory_order_relaxed);
+        counters.bytes_copied.fetch_add(count * element_size, std::memory_order_relaxed);
+    }
+
+    static void OnRelease(size_t size, size_t capacity, size_t) noexcept {
+        StatsCounters& counters = Counters();
+        counters.releases.fetch_add(1, std::memory_order_relaxed);
+        counters.released_size.fetch_add(size, std::memory_order_relaxed);
+        counters.released_capacity.fetch_add(capacity, std::memory_order_relaxed);
+    }
+
+private:
+    static inline const bool registered_ = [] {
+        StatsRegistry::Instance().Add(detail::StatsTagName<Tag>::Get(), Counters());
+        return true;
+    }();
+};
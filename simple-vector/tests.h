@@ -1,8 +1,41 @@
 ﻿#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <list>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "aligned_allocator.h"
+#include "concurrent_simple_vector.h"
+#include "cow_simple_vector.h"
+#include "flat_map.h"
+#include "flat_set.h"
+#include "malloc_allocator.h"
+#include "mapped_simple_vector.h"
+#include "mmap_allocator.h"
+#include "segmented_vector.h"
+#include "serialization.h"
 #include "simple_vector.h"
+#include "simple_vector_view.h"
+#include "small_simple_vector.h"
+#include "static_vector.h"
+#include "soa_vector.h"
+#include "stats_policy.h"
 
 inline void Test1() {
     // Инициализация конструктором по умолчанию
@@ -238,3 +271,1785 @@ inline void Test2() {
 }
 
 
+
+// Тип без конструктора по умолчанию, считающий живые экземпляры
+struct Counted {
+    static inline int alive = 0;
+    explicit Counted(int v) : value(v) { ++alive; }
+    Counted(const Counted& other) : value(other.value) { ++alive; }
+    Counted(Counted&& other) noexcept : value(other.value) { ++alive; }
+    Counted& operator=(const Counted&) = default;
+    Counted& operator=(Counted&&) = default;
+    ~Counted() { --alive; }
+    int value;
+};
+
+inline void TestRawStorage() {
+    // Резервирование не конструирует элементы
+    {
+        SimpleVector<Counted> v(Reserve(100));
+        assert(Counted::alive == 0);
+        v.Reserve(1000);
+        assert(Counted::alive == 0);
+        v.PushBack(Counted(1));
+        v.PushBack(Counted(2));
+        assert(Counted::alive == 2);
+    }
+    assert(Counted::alive == 0);
+
+    // PopBack, Clear и Resize разрушают удаляемые элементы
+    {
+        SimpleVector<Counted> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(Counted(i));
+        }
+        assert(Counted::alive == 10);
+        v.PopBack();
+        assert(Counted::alive == 9);
+        v.Erase(v.begin());
+        assert(Counted::alive == 8);
+        assert(v[0].value == 1);
+        v.Insert(v.begin() + 2, Counted(42));
+        assert(Counted::alive == 9);
+        assert(v[2].value == 42);
+        v.Clear();
+        assert(Counted::alive == 0);
+        assert(v.GetCapacity() >= 10);
+    }
+    assert(Counted::alive == 0);
+
+    // Вставка ссылки на собственный элемент при реаллокации
+    {
+        SimpleVector<Counted> v;
+        v.PushBack(Counted(7));
+        v.PushBack(v[0]);
+        v.Insert(v.begin(), v[1]);
+        assert(v.GetSize() == 3);
+        assert(v[0].value == 7 && v[1].value == 7 && v[2].value == 7);
+    }
+    assert(Counted::alive == 0);
+}
+
+// Аллокатор с идентификатором, распространяющийся при копировании, перемещении и обмене
+template <typename Type>
+struct TaggedAllocator {
+    using value_type = Type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit TaggedAllocator(int tag = 0) : tag(tag) {}
+    template <typename U>
+    TaggedAllocator(const TaggedAllocator<U>& other) : tag(other.tag) {}
+
+    Type* allocate(size_t n) {
+        return std::allocator<Type>().allocate(n);
+    }
+    void deallocate(Type* p, size_t n) {
+        std::allocator<Type>().deallocate(p, n);
+    }
+    bool operator==(const TaggedAllocator& other) const { return tag == other.tag; }
+    bool operator!=(const TaggedAllocator& other) const { return tag != other.tag; }
+
+    int tag;
+};
+
+// Аллокатор со своим construct: копирование не должно обходить его через memcpy
+template <typename Type>
+struct ConstructCountingAllocator : std::allocator<Type> {
+    template <typename U>
+    struct rebind {
+        using other = ConstructCountingAllocator<U>;
+    };
+
+    ConstructCountingAllocator() = default;
+    template <typename U>
+    ConstructCountingAllocator(const ConstructCountingAllocator<U>&) {}
+
+    template <typename... Args>
+    void construct(Type* p, Args&&... args) {
+        ++constructed;
+        ::new (static_cast<void*>(p)) Type(std::forward<Args>(args)...);
+    }
+
+    static inline size_t constructed = 0;
+};
+
+inline void TestAllocator() {
+    // pmr-вектор берёт память из арены и передаёт её вложенным pmr-строкам
+    {
+        std::pmr::monotonic_buffer_resource arena;
+        pmr::SimpleVector<std::pmr::string> v(&arena);
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(std::pmr::string(100, 'a' + i));
+        }
+        v.Insert(v.begin(), std::pmr::string(100, 'z'));
+        assert(v.GetSize() == 11);
+        assert(v[0][0] == 'z' && v[10][0] == 'j');
+        assert(v.GetAllocator().resource() == &arena);
+        assert(v[5].get_allocator().resource() == &arena);
+
+        // копия pmr-вектора по умолчанию использует ресурс по умолчанию
+        pmr::SimpleVector<std::pmr::string> copy(v);
+        assert(copy.GetAllocator().resource() == std::pmr::get_default_resource());
+        assert(copy == v);
+
+        // перемещение в вектор с другим ресурсом переносит элементы по одному
+        std::pmr::monotonic_buffer_resource other_arena;
+        pmr::SimpleVector<std::pmr::string> moved(&other_arena);
+        moved = std::move(v);
+        assert(moved.GetAllocator().resource() == &other_arena);
+        assert(moved == copy);
+    }
+
+    // Распространение аллокатора при копировании, перемещении и обмене
+    {
+        using Vector = SimpleVector<int, TaggedAllocator<int>>;
+        Vector a({1, 2, 3}, TaggedAllocator<int>(1));
+        Vector b(TaggedAllocator<int>(2));
+        b = a;
+        assert(b.GetAllocator().tag == 1);
+        assert(b == a);
+
+        Vector c(TaggedAllocator<int>(3));
+        c = std::move(a);
+        assert(c.GetAllocator().tag == 1);
+        assert(a.IsEmpty());
+
+        Vector d({4}, TaggedAllocator<int>(4));
+        d.swap(c);
+        assert(d.GetAllocator().tag == 1 && c.GetAllocator().tag == 4);
+        assert(c[0] == 4 && d.GetSize() == 3);
+    }
+
+    // Тривиально копируемые элементы копируются memcpy, если construct не переопределён
+    {
+        static_assert(detail::kCopiesBytes<std::allocator<int>, const int*, int>);
+        static_assert(!detail::kCopiesBytes<ConstructCountingAllocator<int>, const int*, int>);
+        static_assert(!detail::kCopiesBytes<std::allocator<std::string>, const std::string*, std::string>);
+        using Vector = SimpleVector<int, ConstructCountingAllocator<int>>;
+        Vector v(100);
+        std::iota(v.begin(), v.end(), 0);
+        ConstructCountingAllocator<int>::constructed = 0;
+        Vector copy(v);
+        assert(copy == v && ConstructCountingAllocator<int>::constructed == 100);
+        copy.Insert(copy.begin() + 50, v.begin(), v.begin() + 10);
+        assert(ConstructCountingAllocator<int>::constructed == 110 && copy[50] == 0 && copy[60] == 50);
+
+        SimpleVector<int> plain(v.begin(), v.end());
+        const SimpleVector<int> plain_copy(plain);
+        plain.Insert(plain.begin() + 50, plain_copy.begin(), plain_copy.begin() + 10);
+        assert(plain_copy.GetSize() == 100 && plain_copy[99] == 99);
+        assert(std::equal(plain.begin(), plain.end(), copy.begin(), copy.end()));
+    }
+}
+
+// Нетривиальный тип, объявивший себя переносимым побайтово
+struct Relocatable {
+    explicit Relocatable(int v) : value(new int(v)) {}
+    Relocatable(const Relocatable& other) : value(new int(*other.value)) {}
+    Relocatable(Relocatable&& other) noexcept : value(std::exchange(other.value, nullptr)) {}
+    Relocatable& operator=(Relocatable other) noexcept {
+        std::swap(value, other.value);
+        return *this;
+    }
+    ~Relocatable() { delete value; }
+    int* value;
+};
+
+template <>
+struct IsTriviallyRelocatable<Relocatable> : std::true_type {
+};
+
+inline void TestRelocation() {
+    static_assert(std::is_nothrow_move_constructible_v<SimpleVector<int>>);
+    static_assert(std::is_nothrow_move_assignable_v<SimpleVector<int>>);
+    static_assert(std::is_nothrow_move_constructible_v<ArrayPtr<int>>);
+
+    // Рост на месте через realloc
+    {
+        SimpleVector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        v.Insert(v.begin() + 500, -1);
+        v.Insert(v.begin(), v[1]);
+        v.Erase(v.begin() + 10);
+        v.Resize(2000);
+        v.Reserve(5000);
+        assert(v.GetSize() == 2000 && v.GetCapacity() == 5000);
+        assert(v[0] == 1 && v[1] == 0 && v[9] == 8 && v[10] == 10);
+        assert(v[499] == 499 && v[500] == -1 && v[501] == 500);
+        assert(v[1000] == 999 && v[1001] == 0);
+    }
+
+    // Побайтовый перенос нетривиального типа
+    {
+        SimpleVector<Relocatable> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(Relocatable(i));
+        }
+        v.Insert(v.begin() + 1, v[50]);
+        v.Erase(v.begin());
+        v.Insert(v.begin() + 3, Relocatable(-3));
+        assert(v.GetSize() == 101);
+        assert(*v[0].value == 50 && *v[1].value == 1 && *v[3].value == -3 && *v[100].value == 99);
+        SimpleVector<SimpleVector<Relocatable>> outer;
+        for (int i = 0; i < 10; ++i) {
+            outer.PushBack(v);
+        }
+        assert(*outer[9][100].value == 99);
+    }
+}
+
+inline void TestMmapAllocator() {
+    // Рост через порог mmap и дальше через mremap
+    {
+        SimpleVector<int, MmapAllocator<int, 4096>> v;
+        for (int i = 0; i < 1000000; ++i) {
+            v.PushBack(i);
+        }
+        v.Insert(v.begin(), -1);
+        assert(v.GetSize() == 1000001);
+        assert(v[0] == -1 && v[1] == 0 && v[1000000] == 999999);
+        SimpleVector<int, MmapAllocator<int, 4096>> copy(v);
+        assert(copy == v);
+        v.Resize(10);
+        assert(v[9] == 8);
+    }
+
+    // Подсказки: предварительная подгрузка страниц при Reserve и huge pages
+    {
+        SimpleVector<int, MmapAllocator<int>> v(MmapAllocator<int>(kMmapPopulate | kMmapHugePages));
+        v.Reserve(1 << 20);
+        v.Reserve(1 << 22);
+        assert(v.GetCapacity() == (1u << 22));
+        assert(v.GetAllocator().GetHints() == (kMmapPopulate | kMmapHugePages));
+        v.Resize(1 << 22);
+        assert(v[(1 << 22) - 1] == 0);
+    }
+}
+
+inline void TestSmallSimpleVector() {
+    // Первые N элементов не выделяют память в куче
+    {
+        SmallSimpleVector<int, 4> v;
+        assert(v.GetCapacity() == 4 && v.IsInline());
+        v.PushBack(1);
+        v.PushBack(3);
+        v.Insert(v.begin() + 1, 2);
+        assert(v.IsInline());
+        assert((v == SmallSimpleVector<int, 4>{1, 2, 3}));
+        v.PushBack(4);
+        v.PushBack(5);
+        assert(!v.IsInline() && v.GetCapacity() == 8);
+        assert((v == SmallSimpleVector<int, 4>{1, 2, 3, 4, 5}));
+        v.Erase(v.begin());
+        v.Resize(2);
+        assert((v == SmallSimpleVector<int, 4>{2, 3}));
+        assert((v < SmallSimpleVector<int, 4>{2, 4}));
+    }
+
+    // После переполнения встроенного буфера вместимость растёт по политике Growth
+    {
+        SmallSimpleVector<int, 4, HalfGrowth> v{1, 2, 3, 4};
+        v.PushBack(5);
+        assert(!v.IsInline() && v.GetCapacity() == 6);
+        v.Insert(v.begin(), 0);
+        v.Insert(v.begin(), -1);
+        assert(v.GetCapacity() == 9 && v[0] == -1 && v[6] == 5);
+        v.Resize(10);
+        assert(v.GetCapacity() == 13 && v[9] == 0);
+
+        SmallSimpleVector<int, 4> doubling{1, 2, 3, 4};
+        doubling.Resize(5);
+        assert(doubling.GetCapacity() == 8 && doubling[4] == 0);
+    }
+
+    // Копирование, перемещение и обмен встроенных и вынесенных в кучу векторов
+    {
+        SmallSimpleVector<Counted, 2> small;
+        small.PushBack(Counted(1));
+        SmallSimpleVector<Counted, 2> big;
+        for (int i = 0; i < 5; ++i) {
+            big.PushBack(Counted(i));
+        }
+        big.Insert(big.begin(), big[4]);
+        assert(big[0].value == 4 && big.GetSize() == 6);
+
+        SmallSimpleVector<Counted, 2> small_copy(small);
+        SmallSimpleVector<Counted, 2> moved(std::move(small_copy));
+        assert(small_copy.IsEmpty() && moved[0].value == 1);
+
+        const Counted* big_data = &big[0];
+        SmallSimpleVector<Counted, 2> moved_big(std::move(big));
+        assert(&moved_big[0] == big_data);
+
+        moved.swap(moved_big);
+        assert(moved.GetSize() == 6 && moved_big.GetSize() == 1);
+        assert(moved_big.IsInline() && moved_big[0].value == 1);
+        moved_big = moved;
+        assert(moved_big.GetSize() == 6 && moved_big[5].value == 4);
+        moved_big.Clear();
+        moved = std::move(moved_big);
+        assert(moved.IsEmpty());
+    }
+    assert(Counted::alive == 0);
+
+    // Тип без конструктора копирования
+    {
+        SmallSimpleVector<std::unique_ptr<int>, 2> v;
+        for (int i = 0; i < 3; ++i) {
+            v.PushBack(std::make_unique<int>(i));
+        }
+        v.Insert(v.begin(), std::make_unique<int>(-1));
+        assert(*v[0] == -1 && *v[3] == 2);
+    }
+}
+
+// Тип, считающий перемещения и копирования
+struct MoveCounter {
+    static inline int moves = 0;
+    static inline int copies = 0;
+    MoveCounter(int a, std::string b) : a(a), b(std::move(b)) {}
+    MoveCounter(const MoveCounter& other) : a(other.a), b(other.b) { ++copies; }
+    MoveCounter(MoveCounter&& other) noexcept : a(other.a), b(std::move(other.b)) { ++moves; }
+    MoveCounter& operator=(const MoveCounter& other) { a = other.a; b = other.b; ++copies; return *this; }
+    MoveCounter& operator=(MoveCounter&& other) noexcept { a = other.a; b = std::move(other.b); ++moves; return *this; }
+    int a;
+    std::string b;
+};
+
+inline void TestEmplace() {
+    {
+        SimpleVector<MoveCounter> v(Reserve(2));
+        MoveCounter::moves = MoveCounter::copies = 0;
+        MoveCounter& first = v.EmplaceBack(1, "one");
+        assert(&first == &v[0] && first.b == "one");
+        v.Emplace(v.end(), 2, "two");
+        assert(MoveCounter::moves == 0 && MoveCounter::copies == 0);
+
+        // при реаллокации новый элемент создаётся на месте, переносятся только старые
+        v.EmplaceBack(3, "three");
+        assert(MoveCounter::moves == 2 && MoveCounter::copies == 0);
+        auto it = v.Emplace(v.begin() + 1, 4, "four");
+        assert(MoveCounter::copies == 0);
+        assert(it == v.begin() + 1 && it->a == 4);
+        assert(v.GetSize() == 4 && v[0].a == 1 && v[2].a == 2 && v[3].b == "three");
+    }
+}
+
+inline void TestRangeInsert() {
+    // Конструктор из диапазона и Append
+    {
+        const std::list<int> source{1, 2, 3};
+        SimpleVector<int> v(source.begin(), source.end());
+        assert((v == SimpleVector<int>{1, 2, 3}));
+        assert(v.GetCapacity() == 3);
+        v.Append(source);
+        const int tail[] = {7, 8};
+        v.Append(tail);
+        v.Append({9});
+        assert((v == SimpleVector<int>{1, 2, 3, 1, 2, 3, 7, 8, 9}));
+
+        std::istringstream input("4 5 6");
+        SimpleVector<int> from_stream(std::istream_iterator<int>(input), std::istream_iterator<int>{});
+        assert((from_stream == SimpleVector<int>{4, 5, 6}));
+    }
+
+    // Вставка с реаллокацией выделяет память один раз
+    {
+        SimpleVector<int> v{1, 2, 3};
+        const int middle[] = {10, 20, 30, 40};
+        auto it = v.Insert(v.begin() + 1, std::begin(middle), std::end(middle));
+        assert(it == v.begin() + 1 && *it == 10);
+        assert((v == SimpleVector<int>{1, 10, 20, 30, 40, 2, 3}));
+        assert(v.GetCapacity() == 7);
+
+        v.Insert(v.begin(), 2, -1);
+        v.Insert(v.end(), 0, 5);
+        v.Insert(v.begin() + 3, {0, 0});
+        assert((v == SimpleVector<int>{-1, -1, 1, 0, 0, 10, 20, 30, 40, 2, 3}));
+
+        // count копий собственного элемента
+        v.Insert(v.begin(), 3, v[6]);
+        assert(v[0] == 20 && v[2] == 20 && v[3] == -1);
+    }
+
+    // Нетривиальные элементы: хвост длиннее и короче вставки, однопроходный диапазон
+    for (size_t pos = 0; pos <= 5; ++pos) {
+        for (size_t count = 0; count <= 7; ++count) {
+            SimpleVector<std::string> v(Reserve(20));
+            std::list<std::string> expected;
+            for (int i = 0; i < 5; ++i) {
+                v.PushBack(std::to_string(i));
+                expected.push_back(std::to_string(i));
+            }
+            SimpleVector<std::string> inserted(count, std::string(30, 'x'));
+            v.Insert(v.begin() + pos, inserted.begin(), inserted.end());
+            expected.insert(std::next(expected.begin(), pos), inserted.begin(), inserted.end());
+            assert(v == SimpleVector<std::string>(expected.begin(), expected.end()));
+        }
+    }
+    {
+        SimpleVector<std::string> v{"a", "d"};
+        std::istringstream input("b c");
+        v.Insert(v.begin() + 1, std::istream_iterator<std::string>(input), std::istream_iterator<std::string>{});
+        assert((v == SimpleVector<std::string>{"a", "b", "c", "d"}));
+    }
+}
+
+template <typename Type>
+void CheckRemoveIfKernels() {
+    std::mt19937 gen(11);
+    for(size_t size = 0; size < 80; ++size){
+        for(unsigned modulo : {1u, 2u, 3u, 7u}){
+            std::vector<Type> source(size);
+            for(Type& x : source){
+                x = static_cast<Type>(gen() % 100);
+            }
+            size_t calls = 0;
+            auto pred = [modulo, &calls](Type x) {
+                ++calls;
+                return static_cast<unsigned>(x) % modulo == 0;
+            };
+            std::vector<Type> expected = source;
+            expected.erase(std::remove_if(expected.begin(), expected.end(), pred), expected.end());
+
+            std::vector<Type> scalar = source;
+            calls = 0;
+            Type* scalar_end = detail::RemoveIfBranchless(scalar.data(), scalar.data() + size, scalar.data(), pred);
+            assert(calls == size);
+            assert(std::equal(scalar.data(), scalar_end, expected.begin(), expected.end()));
+
+            std::vector<Type> dispatched = source;
+            calls = 0;
+            Type* dispatched_end = detail::RemoveIfArithmetic(dispatched.data(), dispatched.data() + size, pred);
+            assert(calls == size);
+            assert(std::equal(dispatched.data(), dispatched_end, expected.begin(), expected.end()));
+#ifdef SIMPLE_VECTOR_X86_KERNELS
+            if constexpr (sizeof(Type) == 4 || sizeof(Type) == 8) {
+                if(detail::CpuHasAvx2()){
+                    std::vector<Type> simd = source;
+                    Type* simd_end = detail::RemoveIfAvx2(simd.data(), simd.data() + size, pred);
+                    assert(std::equal(simd.data(), simd_end, expected.begin(), expected.end()));
+                }
+            }
+#endif
+        }
+    }
+}
+
+inline void TestRangeErase() {
+    {
+        SimpleVector<int> v{0, 1, 2, 3, 4, 5, 6};
+        auto it = v.Erase(v.begin() + 1, v.begin() + 4);
+        assert(*it == 4);
+        assert((v == SimpleVector<int>{0, 4, 5, 6}));
+        assert(v.Erase(v.begin(), v.begin()) == v.begin());
+        v.Erase(v.begin() + 2, v.end());
+        assert((v == SimpleVector<int>{0, 4}));
+    }
+
+    // Удалённые элементы разрушаются
+    {
+        SimpleVector<Counted> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(Counted(i));
+        }
+        v.Erase(v.begin() + 2, v.begin() + 5);
+        assert(Counted::alive == 7 && v[2].value == 5);
+        const size_t removed = EraseIf(v, [](const Counted& c) {
+            return c.value % 2 == 0;
+        });
+        assert(removed == 3 && Counted::alive == 4);
+        assert(v[0].value == 1 && v[1].value == 5 && v[2].value == 7 && v[3].value == 9);
+    }
+    assert(Counted::alive == 0);
+
+    // Арифметические типы и нетривиальные элементы
+    {
+        SimpleVector<int> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(i % 10);
+        }
+        assert(Erase(v, 3) == 100);
+        assert(EraseIf(v, [](int x) { return x > 5; }) == 400);
+        assert(v.GetSize() == 500);
+        assert((SimpleVector<int>(v.begin(), v.begin() + 6) == SimpleVector<int>{0, 1, 2, 4, 5, 0}));
+
+        SimpleVector<std::string> words{"a", "b", "a", "c"};
+        assert(Erase(words, "a") == 2);
+        assert((words == SimpleVector<std::string>{"b", "c"}));
+    }
+
+    // Скалярное ядро и ядро AVX2 совпадают с std::remove_if
+    CheckRemoveIfKernels<int32_t>();
+    CheckRemoveIfKernels<float>();
+    CheckRemoveIfKernels<double>();
+    CheckRemoveIfKernels<uint64_t>();
+    CheckRemoveIfKernels<int16_t>();
+}
+
+inline void TestGrowthPolicy() {
+    // Политика по умолчанию: 0 -> 1, далее вдвое; Resize растёт по той же политике
+    {
+        SimpleVector<int> v;
+        v.PushBack(1);
+        assert(v.GetCapacity() == 1);
+        v.PushBack(2);
+        v.PushBack(3);
+        assert(v.GetCapacity() == 4);
+        v.Resize(5);
+        assert(v.GetCapacity() == 8);
+        v.Resize(100);
+        assert(v.GetCapacity() == 100);
+    }
+
+    // Рост в 1.5 раза
+    {
+        SimpleVector<int, std::allocator<int>, HalfGrowth> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.GetCapacity() == 6);
+        v.Insert(v.begin(), 2, 0);
+        assert(v.GetCapacity() == 9);
+        assert(v[0] == 0 && v[2] == 0 && v[6] == 4);
+    }
+
+    // Округление до размерного класса аллокатора
+    {
+        SimpleVector<int, std::allocator<int>, SizeClassGrowth<>> v;
+        v.PushBack(1);
+        assert(v.GetCapacity() == 4);
+        v.Resize(1100);
+        assert(v.GetCapacity() * sizeof(int) % 4096 == 0);
+    }
+
+    // ShrinkToFit
+    {
+        SimpleVector<int> v(1000, 1);
+        v.Erase(v.begin() + 10, v.end());
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 10 && v.GetSize() == 10 && v[9] == 1);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 0 && v.begin() == nullptr);
+
+        SimpleVector<std::string, MallocAllocator<std::string>> words{"a", "b", "c"};
+        words.PopBack();
+        words.ShrinkToFit();
+        assert(words.GetCapacity() == 2 && words[1] == "b");
+    }
+}
+
+// Конструктор по умолчанию бросает исключение на третьем вызове
+struct ThrowOnThird {
+    static inline int created = 0;
+    static inline int alive = 0;
+    ThrowOnThird() {
+        if (++created == 3) {
+            throw std::runtime_error("default");
+        }
+        ++alive;
+    }
+    ThrowOnThird(const ThrowOnThird& other) : payload(other.payload) { ++alive; }
+    ThrowOnThird& operator=(const ThrowOnThird&) = default;
+    ~ThrowOnThird() { --alive; }
+    std::string payload = "p";
+};
+
+inline void TestResizeDefaultInit() {
+    // Новые байты не инициализируются, старые сохраняются
+    {
+        SimpleVector<uint8_t> buffer{1, 2, 3};
+        buffer.ResizeUninitialized(4096);
+        assert(buffer.GetSize() == 4096);
+        assert(buffer[0] == 1 && buffer[2] == 3);
+        std::memset(buffer.begin() + 3, 7, 4093);
+        assert(buffer[4095] == 7);
+    }
+
+    // Чтение блоками через AppendDefaultInit
+    {
+        std::istringstream input(std::string(10000, 'q'));
+        SimpleVector<char> buffer;
+        const size_t chunk = 4096;
+        while (true) {
+            const size_t old_size = buffer.GetSize();
+            char* dst = buffer.AppendDefaultInit(chunk);
+            input.read(dst, chunk);
+            buffer.Resize(old_size + static_cast<size_t>(input.gcount()));
+            if (input.gcount() == 0) {
+                break;
+            }
+        }
+        assert(buffer.GetSize() == 10000);
+        assert(buffer[0] == 'q' && buffer[9999] == 'q');
+    }
+
+    // Нетривиальные типы конструируются конструктором по умолчанию
+    {
+        SimpleVector<std::string> v{"a"};
+        v.ResizeDefaultInit(3);
+        assert(v[0] == "a" && v[2].empty());
+    }
+
+    // Исключение конструктора по умолчанию разрушает уже созданные элементы
+    {
+        SimpleVector<ThrowOnThird> v(1);
+        try {
+            v.ResizeDefaultInit(5);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.GetSize() == 1 && ThrowOnThird::alive == 1);
+    }
+
+    // Переопределённый construct аллокатора не обходится
+    {
+        SimpleVector<std::string, ConstructCountingAllocator<std::string>> v;
+        ConstructCountingAllocator<std::string>::constructed = 0;
+        v.ResizeDefaultInit(4);
+        assert(v.GetSize() == 4 && v[3].empty());
+        assert(ConstructCountingAllocator<std::string>::constructed == 4);
+    }
+}
+
+inline void TestAlignedStorage() {
+    static_assert(SimpleVector<float>::kAlignment == alignof(float));
+    static_assert(AlignedSimpleVector<float>::kAlignment == 64);
+
+    AlignedSimpleVector<float> v;
+    for (int i = 0; i < 1000; ++i) {
+        v.PushBack(static_cast<float>(i));
+        assert(v.IsAligned(64));
+    }
+    v.Reserve(5000);
+    assert(v.IsAligned());
+    v.Resize(10000);
+    assert(v.IsAligned());
+    v.Insert(v.begin(), 3, -1.0f);
+    assert(v.IsAligned());
+    const float* data = v.AlignedData();
+    assert(data == v.begin() && data[3] == 0.0f && data[1002] == 999.0f);
+
+    AlignedSimpleVector<float> copy(v);
+    assert(copy.IsAligned() && copy == v);
+
+    SimpleVector<double, AlignedAllocator<double, 128>> wide(17, 1.0);
+    assert(wide.IsAligned(128));
+}
+
+template <typename Type>
+void CheckComparisonKernels(std::mt19937& rng) {
+    std::uniform_int_distribution<int> value(-3, 3);
+    for (int iteration = 0; iteration < 300; ++iteration) {
+        const size_t size = static_cast<size_t>(rng() % 200);
+        SimpleVector<Type> lhs(size);
+        for (size_t i = 0; i < size; ++i) {
+            lhs[i] = static_cast<Type>(value(rng));
+        }
+        SimpleVector<Type> rhs(lhs);
+        if (!rhs.IsEmpty() && rng() % 4 != 0) {
+            rhs[rng() % size] = static_cast<Type>(value(rng));
+        }
+        if (rng() % 4 == 0) {
+            rhs.Resize(rng() % (size + 2));
+        }
+        const bool expected_equal = std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        const bool expected_less = std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        assert((lhs == rhs) == expected_equal);
+        assert((lhs < rhs) == expected_less);
+        assert((lhs > rhs) == std::lexicographical_compare(rhs.begin(), rhs.end(), lhs.begin(), lhs.end()));
+    }
+}
+
+inline void TestComparisonKernels() {
+    std::mt19937 rng(42);
+    CheckComparisonKernels<int>(rng);
+    CheckComparisonKernels<uint8_t>(rng);
+    CheckComparisonKernels<int8_t>(rng);
+    CheckComparisonKernels<uint64_t>(rng);
+    CheckComparisonKernels<double>(rng);
+
+    // Различие за пределами первой линии кэша и знак у целых со знаком
+    {
+        SimpleVector<int> lhs(1000, 1);
+        SimpleVector<int> rhs(lhs);
+        rhs[777] = -1;
+        assert(lhs != rhs && rhs < lhs);
+        assert(detail::Mismatch(lhs.begin(), rhs.begin(), 1000) == 777);
+    }
+    {
+        SimpleVector<double> lhs{0.0};
+        SimpleVector<double> rhs{-0.0};
+        assert(lhs == rhs);
+    }
+    assert((SimpleVector<uint8_t>{1, 2} < SimpleVector<uint8_t>{1, 2, 0}));
+    assert((SmallSimpleVector<char, 4>{'a', 'b'} < SmallSimpleVector<char, 4>{'a', 'c'}));
+}
+
+// Тип, конструктор копирования которого бросает исключение на заданном значении
+struct ThrowOnCopy {
+    static inline std::atomic<int> alive = 0;
+    explicit ThrowOnCopy(int v) : value(v) { ++alive; }
+    ThrowOnCopy(const ThrowOnCopy& other) : value(other.value) {
+        if (value < 0) {
+            throw std::runtime_error("copy");
+        }
+        ++alive;
+    }
+    ThrowOnCopy& operator=(const ThrowOnCopy&) = default;
+    ~ThrowOnCopy() { --alive; }
+    int value;
+};
+
+inline void TestParallelConstruction() {
+    const ParallelPolicy policy{4, 1000};
+    {
+        SimpleVector<int> v(1000000, 7, policy);
+        assert(v.GetSize() == 1000000 && v[0] == 7 && v[999999] == 7);
+        std::iota(v.begin(), v.end(), 0);
+        SimpleVector<int> copy(v, policy);
+        assert(copy == v);
+
+        SimpleVector<int> small(10, 1, kParallel);
+        assert((small == SimpleVector<int>(10, 1)));
+    }
+    {
+        SimpleVector<std::string> v(5000, "text", policy);
+        SimpleVector<std::string> copy(v, policy);
+        assert(copy == v && copy[4999] == "text");
+    }
+
+    // Исключение в одном из потоков: созданные элементы разрушаются, память освобождается
+    {
+        SimpleVector<ThrowOnCopy> v;
+        for (int i = 0; i < 5000; ++i) {
+            v.EmplaceBack(i == 4321 ? -1 : i);
+        }
+        const int alive = ThrowOnCopy::alive;
+        try {
+            SimpleVector<ThrowOnCopy> copy(v, policy);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(ThrowOnCopy::alive == alive);
+    }
+}
+
+inline void TestMappedSimpleVector() {
+    const std::string path = (std::filesystem::temp_directory_path() / "mapped_simple_vector_test.bin").string();
+    std::filesystem::remove(path);
+
+    // Создание и рост файла
+    {
+        MappedSimpleVector<int> v(path);
+        assert(v.IsEmpty() && v.GetCapacity() == 0);
+        for (int i = 0; i < 100000; ++i) {
+            v.PushBack(i);
+        }
+        v.PushBack(v[0]);
+        assert(v.GetSize() == 100001 && v[100000] == 0);
+        v.Resize(200000);
+        assert(v[150000] == 0);
+        v.Resize(100000);
+        v.Flush();
+    }
+
+    // Повторное открытие без разбора данных
+    {
+        MappedSimpleVector<int> v(path);
+        assert(v.GetSize() == 100000);
+        assert(v.GetCapacity() >= 200000);
+        assert(v[0] == 0 && v[99999] == 99999);
+        assert(std::equal(v.begin(), v.end(), SimpleVector<int>(v.begin(), v.end()).begin()));
+        v.PopBack();
+        MappedSimpleVector<int> moved(std::move(v));
+        assert(moved.GetSize() == 99999);
+        try {
+            moved.At(99999);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        // Перемещённый вектор пуст
+        assert(v.GetSize() == 0 && v.IsEmpty() && v.GetCapacity() == 0);
+        assert(v.begin() == v.end() && std::as_const(v).begin() == std::as_const(v).end());
+        v.Clear();
+        try {
+            v.At(0);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        v = std::move(moved);
+        assert(v.GetSize() == 99999 && moved.IsEmpty());
+    }
+
+    // Файл другого типа отвергается
+    try {
+        MappedSimpleVector<double> wrong(path);
+        assert(false);
+    } catch (const std::runtime_error&) {
+    }
+    std::filesystem::remove(path);
+}
+
+inline void TestSerialization() {
+    // Тривиально копируемые элементы: один блок байтов
+    {
+        SimpleVector<int> v(300000);
+        std::iota(v.begin(), v.end(), -7);
+        std::stringstream stream;
+        Save(stream, v);
+        SimpleVector<int> loaded{1, 2, 3};
+        Load(stream, loaded);
+        assert(loaded == v);
+        assert(loaded.GetCapacity() == v.GetSize());
+    }
+
+    // Потоковое чтение кусками
+    {
+        SimpleVector<double> v{1.5, 2.5, 3.5, 4.5, 5.5};
+        std::stringstream stream;
+        Save(stream, v);
+        SimpleVectorReader<double> reader{StreamSource(stream)};
+        assert(reader.GetSizeHint() == 5);
+        SimpleVector<double> dest;
+        assert(reader.ReadChunk(dest, 2) == 2 && dest.GetSize() == 2);
+        assert(reader.ReadChunk(dest, 2) == 2 && reader.GetRemaining() == 1);
+        assert(reader.ReadChunk(dest, 2) == 1);
+        assert(reader.ReadChunk(dest, 2) == 0);
+        assert(dest == v);
+    }
+
+    // Нетривиальные элементы через ElementSerializer
+    {
+        SimpleVector<std::string> v{"", "a", std::string(1000, 'x')};
+        std::stringstream stream;
+        Save(stream, v);
+        SimpleVector<std::string> loaded;
+        Load(stream, loaded);
+        assert(loaded == v);
+    }
+
+    // Файловый дескриптор
+    {
+        const std::string path = (std::filesystem::temp_directory_path() / "simple_vector_serialization_test.bin").string();
+        SimpleVector<uint64_t> v(100000, 42);
+        const int out = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        assert(out >= 0);
+        Save(out, v);
+        ::close(out);
+        const int in = ::open(path.c_str(), O_RDONLY);
+        assert(in >= 0);
+        SimpleVector<uint64_t> loaded;
+        Load(in, loaded);
+        ::close(in);
+        assert(loaded == v);
+        std::filesystem::remove(path);
+    }
+
+    // Повреждённые данные: не тот тип, обрыв
+    {
+        SimpleVector<int> v(10, 1);
+        std::stringstream stream;
+        Save(stream, v);
+        const std::string bytes = stream.str();
+        try {
+            std::stringstream copy(bytes);
+            SimpleVector<int64_t> wrong;
+            Load(copy, wrong);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        try {
+            std::stringstream truncated(bytes.substr(0, bytes.size() - 1));
+            SimpleVector<int> loaded{1, 2, 3};
+            Load(truncated, loaded);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    // Заголовок с огромным числом элементов: память не выделяется заранее,
+    // неудачная загрузка не трогает вектор-приёмник
+    {
+        SimpleVector<int> v(10, 1);
+        std::stringstream stream;
+        Save(stream, v);
+        std::string bytes = stream.str();
+        const uint64_t huge = uint64_t{1} << 34;
+        std::memcpy(bytes.data() + offsetof(SerializedHeader, size), &huge, sizeof(huge));
+        SimpleVector<int> loaded{1, 2, 3};
+        try {
+            std::stringstream corrupt(bytes);
+            Load(corrupt, loaded);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert((loaded == SimpleVector<int>{1, 2, 3}));
+
+        // Для файла заголовок сверяется с его размером ещё до чтения элементов
+        const std::string path = (std::filesystem::temp_directory_path() / "simple_vector_corrupt_test.bin").string();
+        const int out = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        assert(out >= 0);
+        Save(out, v);
+        ::close(out);
+        int in = ::open(path.c_str(), O_RDONLY);
+        assert(in >= 0);
+        SimpleVectorReader<int, FdSource> checked{FdSource(in)};
+        assert(checked.IsSizeChecked() && checked.GetSizeHint() == 10);
+        ::close(in);
+        in = ::open(path.c_str(), O_RDWR);
+        assert(in >= 0);
+        assert(::pwrite(in, &huge, sizeof(huge), offsetof(SerializedHeader, size)) == sizeof(huge));
+        try {
+            Load(in, loaded);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        ::close(in);
+        assert((loaded == SimpleVector<int>{1, 2, 3}));
+        std::filesystem::remove(path);
+    }
+
+    // Строка с огромной длиной читается кусками до обрыва
+    {
+        SimpleVector<std::string> v{"abc"};
+        std::stringstream stream;
+        Save(stream, v);
+        std::string bytes = stream.str();
+        const uint64_t huge = uint64_t{1} << 40;
+        std::memcpy(bytes.data() + sizeof(SerializedHeader), &huge, sizeof(huge));
+        SimpleVector<std::string> loaded{"kept"};
+        try {
+            std::stringstream corrupt(bytes);
+            Load(corrupt, loaded);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(loaded.GetSize() == 1 && loaded[0] == "kept");
+    }
+}
+
+inline void TestConcurrentSimpleVector() {
+    // Однопоточное использование и стабильность ссылок
+    {
+        ConcurrentSimpleVector<std::string> v;
+        assert(v.IsEmpty());
+        const std::string& first = v.EmplaceBack("first");
+        for (int i = 0; i < 1000; ++i) {
+            assert(v.PushBack(std::to_string(i)) == static_cast<size_t>(i) + 1);
+        }
+        assert(&first == &v[0] && first == "first");
+        assert(v.GetSize() == 1001 && v.GetCapacity() >= 1001);
+        assert(v.GrowBy(100, "x") == 1001);
+        assert(v[1100] == "x" && v.At(500) == "499");
+        try {
+            v.At(1101);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        v.Clear();
+        assert(v.IsEmpty());
+        v.Reserve(5000);
+        assert(v.GetCapacity() >= 5000);
+    }
+
+    // Нагрузочный тест: писатели добавляют, читатель одновременно проверяет опубликованные элементы
+    {
+        constexpr size_t kWriters = 8;
+        constexpr size_t kPerWriter = 20000;
+        ConcurrentSimpleVector<size_t> v;
+        std::vector<std::atomic<size_t>> published(kWriters);
+        for (auto& index : published) {
+            index.store(SIZE_MAX);
+        }
+        std::atomic<bool> done{false};
+        std::atomic<size_t> checked{0};
+
+        std::thread reader([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                for (size_t writer = 0; writer < kWriters; ++writer) {
+                    const size_t index = published[writer].load(std::memory_order_acquire);
+                    if (index != SIZE_MAX) {
+                        assert(v[index] / kPerWriter == writer);
+                        checked.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+        std::vector<std::thread> writers;
+        std::vector<std::vector<size_t>> indices(kWriters);
+        for (size_t writer = 0; writer < kWriters; ++writer) {
+            writers.emplace_back([&, writer] {
+                for (size_t i = 0; i < kPerWriter; ++i) {
+                    const size_t index = i % 100 == 0 ? v.GrowBy(1, writer * kPerWriter + i)
+                                                      : v.PushBack(writer * kPerWriter + i);
+                    indices[writer].push_back(index);
+                    published[writer].store(index, std::memory_order_release);
+                }
+            });
+        }
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+        done.store(true, std::memory_order_release);
+        reader.join();
+
+        assert(v.GetSize() == kWriters * kPerWriter);
+        std::vector<bool> seen(kWriters * kPerWriter);
+        for (size_t writer = 0; writer < kWriters; ++writer) {
+            for (size_t i = 0; i < kPerWriter; ++i) {
+                const size_t value = v[indices[writer][i]];
+                assert(value == writer * kPerWriter + i);
+                assert(!seen[value]);
+                seen[value] = true;
+            }
+        }
+    }
+
+    // Читатель обходит [0, GetSize()) во время записи и видит только сконструированные элементы
+    {
+        constexpr size_t kWriters = 4;
+        constexpr size_t kPerWriter = 5000;
+        ConcurrentSimpleVector<std::string> v;
+        std::atomic<bool> done{false};
+        std::thread reader([&] {
+            size_t seen = 0;
+            while (!done.load(std::memory_order_acquire) || seen < v.GetSize()) {
+                const size_t size = v.GetSize();
+                assert(size >= seen);
+                for (size_t index = 0; index < size; ++index) {
+                    assert(v[index].size() == 40 && v[index][0] == v[index][39]);
+                }
+                seen = size;
+            }
+        });
+        std::vector<std::thread> writers;
+        for (size_t writer = 0; writer < kWriters; ++writer) {
+            writers.emplace_back([&, writer] {
+                const std::string value(40, static_cast<char>('a' + writer));
+                for (size_t i = 0; i < kPerWriter; ++i) {
+                    i % 10 == 0 ? v.GrowBy(3, value) : v.PushBack(value);
+                }
+            });
+        }
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+        done.store(true, std::memory_order_release);
+        reader.join();
+        assert(v.GetSize() == kWriters * (kPerWriter + kPerWriter / 10 * 2));
+    }
+
+    // Исключение конструктора передаётся вызывающему, ячейка публикуется пустой
+    {
+        {
+            ConcurrentSimpleVector<ThrowOnCopy> v;
+            v.PushBack(ThrowOnCopy(1));
+            try {
+                v.GrowBy(3, ThrowOnCopy(-1));
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.GetSize() == 4 && ThrowOnCopy::alive == 1);
+            assert(v.HasElement(0) && !v.HasElement(1) && !v.HasElement(3) && !v.HasElement(4));
+            assert(v.PushBack(ThrowOnCopy(2)) == 4 && v[4].value == 2 && v.HasElement(4));
+        }
+        assert(ThrowOnCopy::alive == 0);
+    }
+
+    // Нехватка памяти под сегмент не резервирует ячейки
+    {
+        alignas(std::max_align_t) std::byte buffer[16 * sizeof(int)];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        ConcurrentSimpleVector<int, std::pmr::polymorphic_allocator<int>> v(&arena);
+        v.GrowBy(16, 7);
+        try {
+            v.PushBack(8);
+            assert(false);
+        } catch (const std::bad_alloc&) {
+        }
+        assert(v.GetSize() == 16 && v.GetCapacity() == 16 && v[15] == 7);
+    }
+
+    // Разрушение элементов
+    {
+        {
+            ConcurrentSimpleVector<Counted> v;
+            v.GrowBy(100, Counted(1));
+            v.EmplaceBack(2);
+            assert(Counted::alive == 101);
+        }
+        assert(Counted::alive == 0);
+    }
+}
+
+inline void TestSegmentedVector() {
+    // Рост не перемещает элементы
+    {
+        SegmentedVector<int, 16> v;
+        v.PushBack(0);
+        const int* first = &v[0];
+        for (int i = 1; i < 1000; ++i) {
+            v.PushBack(i);
+        }
+        assert(first == &v[0]);
+        assert(v.GetSize() == 1000 && v.GetChunkCount() == 63 && v.GetCapacity() == 1008);
+        assert(v[999] == 999 && v.At(500) == 500);
+        try {
+            v.At(1000);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+    }
+
+    // Итераторы произвольного доступа и алгоритмы
+    {
+        SegmentedVector<int, 16> v(100);
+        std::iota(v.begin(), v.end(), 0);
+        std::reverse(v.begin(), v.end());
+        assert(v[0] == 99 && v[99] == 0);
+        std::sort(v.begin(), v.end());
+        assert(std::is_sorted(v.cbegin(), v.cend()));
+        auto it = std::lower_bound(v.begin(), v.end(), 40);
+        assert(it - v.begin() == 40 && *it == 40);
+        assert(it.ChunkEnd() == &v[47] + 1);
+        SegmentedVector<int, 16>::ConstIterator cit = it;
+        assert(cit == it && cit[2] == 42);
+
+        v.Insert(v.begin() + 10, -1);
+        assert(v[10] == -1 && v[11] == 10 && v.GetSize() == 101);
+        v.Erase(v.begin() + 10);
+        assert(v[10] == 10);
+        v.Erase(v.begin(), v.begin() + 50);
+        assert(v.GetSize() == 50 && v[0] == 50);
+    }
+
+    // Обход по непрерывным кускам
+    {
+        SegmentedVector<int, 16> v(100, 1);
+        size_t chunks = 0;
+        long long sum = 0;
+        v.ForEachChunk([&](const int* first, const int* last) {
+            ++chunks;
+            sum = std::accumulate(first, last, sum);
+        });
+        assert(chunks == 7 && sum == 100);
+        chunks = 0;
+        v.ForEachChunk(v.begin() + 10, v.begin() + 40, [&](int* first, int* last) {
+            ++chunks;
+            std::fill(first, last, 2);
+        });
+        assert(chunks == 3 && v[9] == 1 && v[10] == 2 && v[39] == 2 && v[40] == 1);
+    }
+
+    // Копирование, сравнение, очистка
+    {
+        SegmentedVector<std::string, 16> v{"a", "b", "c"};
+        v.Resize(40, "z");
+        SegmentedVector<std::string, 16> copy(v);
+        assert(copy == v);
+        copy[39] = "zz";
+        assert(v < copy && copy > v && v != copy);
+        SegmentedVector<std::string, 16> moved(std::move(copy));
+        assert(moved.GetSize() == 40 && copy.IsEmpty());
+        moved.Resize(3);
+        moved.ShrinkToFit();
+        assert(moved.GetChunkCount() == 1);
+        moved.swap(v);
+        assert(moved.GetSize() == 40 && v.GetSize() == 3);
+    }
+    {
+        {
+            SegmentedVector<Counted, 16> v(50, Counted(1));
+            v.EmplaceBack(2);
+            v.PopBack();
+            assert(Counted::alive == 50);
+            v.Clear();
+            assert(Counted::alive == 0 && v.GetCapacity() >= 50);
+            v.EmplaceBack(3);
+        }
+        assert(Counted::alive == 0);
+    }
+}
+
+inline void TestCowSimpleVector() {
+    // Копии разделяют буфер до первого изменения
+    {
+        CowSimpleVector<int> v{1, 2, 3};
+        const CowSimpleVector<int> copy = v;
+        assert(v.UseCount() == 2 && copy.IsShared());
+        assert(&v.Get() == &copy.Get() && v == copy);
+        assert(copy[1] == 2 && copy.At(2) == 3);
+
+        v[0] = 10;
+        assert(!v.IsShared() && !copy.IsShared());
+        assert(v[0] == 10 && copy[0] == 1 && v != copy);
+
+        CowSimpleVector<int> another = copy;
+        another.PushBack(4);
+        another.Insert(0, 0);
+        another.Erase(1);
+        assert(another.GetSize() == 4 && another[0] == 0 && another[3] == 4);
+        assert(copy.GetSize() == 3 && copy.UseCount() == 1);
+    }
+
+    // Общий буфер не делает равными векторы с NaN: результат как у SimpleVector
+    {
+        const CowSimpleVector<double> v{1.0, std::numeric_limits<double>::quiet_NaN()};
+        const CowSimpleVector<double> copy = v;
+        assert(copy.IsShared());
+        assert((v == copy) == (v.Get() == copy.Get()) && v != copy);
+    }
+
+    // Отделение при Resize, итерации, Clear разделяемого буфера
+    {
+        CowSimpleVector<std::string> v(3, "a");
+        CowSimpleVector<std::string> copy;
+        copy = v;
+        for (std::string& item : v) {
+            item += "b";
+        }
+        assert(v[2] == "ab" && copy[2] == "a");
+        copy.Resize(5);
+        assert(copy.GetSize() == 5 && v.GetSize() == 3);
+        CowSimpleVector<std::string> third = v;
+        third.Clear();
+        assert(third.IsEmpty() && v.GetSize() == 3 && v.UseCount() == 1);
+        assert(third < v && v > copy);
+    }
+
+    // Обычный вектор забирается без копирования
+    {
+        SimpleVector<int> source(1000, 7);
+        const int* data = source.begin();
+        CowSimpleVector<int> v(std::move(source));
+        assert(v.cbegin() == data);
+        CowSimpleVector<int> moved(std::move(v));
+        assert(v.IsEmpty() && v.UseCount() == 0 && moved.GetSize() == 1000);
+    }
+
+    // Копии в разных потоках: счётчик ссылок атомарный
+    {
+        const CowSimpleVector<Counted> shared(100, Counted(1));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&shared] {
+                for (int i = 0; i < 1000; ++i) {
+                    CowSimpleVector<Counted> copy = shared;
+                    if (i % 100 == 0) {
+                        copy[0].value = i;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        assert(shared.UseCount() == 1 && shared[0].value == 1);
+    }
+    assert(Counted::alive == 0);
+}
+
+inline long long SumView(SimpleVectorView<const int> view) {
+    return std::accumulate(view.begin(), view.end(), 0LL);
+}
+
+inline void TestSimpleVectorView() {
+    SimpleVector<int> v(100);
+    std::iota(v.begin(), v.end(), 0);
+
+    // Неявное приведение вектора и нарезка без копирования
+    assert(SumView(v) == 4950);
+    const SimpleVectorView<const int> all = v;
+    assert(all.Data() == v.begin() && all.GetSize() == 100);
+    assert(all.First(10).GetSize() == 10 && all.First(10)[9] == 9);
+    assert(all.Last(10)[0] == 90 && all.Last(0).IsEmpty());
+    const auto middle = all.Subview(40, 20);
+    assert(middle[0] == 40 && middle.GetSize() == 20 && middle.At(19) == 59);
+    assert(all.Subview(95).GetSize() == 5 && all.Subview(100).IsEmpty());
+    try {
+        all.Subview(101);
+        assert(false);
+    } catch (const std::out_of_range&) {
+    }
+    try {
+        middle.At(20);
+        assert(false);
+    } catch (const std::out_of_range&) {
+    }
+
+    // Раздача частей по пакетам
+    long long total = 0;
+    for (size_t offset = 0; offset < all.GetSize(); offset += 30) {
+        total += SumView(all.Subview(offset, 30));
+    }
+    assert(total == 4950);
+
+    // Изменяемое представление
+    SimpleVectorView<int> writable = v;
+    for (int& item : writable.Subview(0, 10)) {
+        item = -item;
+    }
+    assert(v[9] == -9 && v[10] == 10);
+    SimpleVectorView<const int> readonly = writable;
+    assert(readonly == writable);
+
+    // Сравнения с векторами и между представлениями
+    const SimpleVector<int> prefix{0, -1, -2};
+    assert(all.First(3) == prefix && prefix == all.First(3));
+    assert(all.First(2) < prefix && all.First(4) > prefix);
+    assert(all.Subview(10, 3) != all.Subview(11, 3));
+    assert(SimpleVectorView<const int>() == SimpleVector<int>());
+}
+
+inline void TestSoAVector() {
+    SoAVector<int, double, std::string> table;
+    assert(table.IsEmpty());
+    for (int i = 0; i < 100; ++i) {
+        table.PushBack(i, i * 0.5, std::to_string(i));
+    }
+    assert(table.GetSize() == 100 && table.GetCapacity() >= 100);
+
+    // Строка - кортеж ссылок на поля
+    auto [id, weight, name] = table[10];
+    assert(id == 10 && weight == 5.0 && name == "10");
+    std::get<1>(table[10]) = 42.0;
+    assert(std::get<1>(table.At(10)) == 42.0);
+    try {
+        table.At(100);
+        assert(false);
+    } catch (const std::out_of_range&) {
+    }
+
+    // Столбцы непрерывны и читаются отдельно
+    SimpleVectorView<int> ids = table.Column<0>();
+    assert(ids.GetSize() == 100 && &ids[1] == &ids[0] + 1);
+    assert(std::accumulate(ids.begin(), ids.end(), 0) == 4950);
+    for (double& value : table.Column<1>()) {
+        value = 1.0;
+    }
+    const auto& const_table = table;
+    SimpleVectorView<const double> weights = const_table.Column<1>();
+    assert(std::accumulate(weights.begin(), weights.end(), 0.0) == 100.0);
+
+    // Обход строк
+    int rows = 0;
+    for (auto [row_id, row_weight, row_name] : table) {
+        assert(row_name == std::to_string(row_id) && row_weight == 1.0);
+        row_name += "!";
+        ++rows;
+    }
+    assert(rows == 100 && std::get<2>(const_table[0]) == "0!");
+
+    // Изменение размера, удаление, сравнение
+    SoAVector<int, double, std::string> copy = table;
+    assert(copy == table);
+    copy.Erase(0);
+    assert(copy.GetSize() == 99 && std::get<0>(copy[0]) == 1 && copy != table);
+    copy.PopBack();
+    copy.Resize(200);
+    assert(copy.GetSize() == 200 && std::get<2>(copy[199]).empty());
+    copy.Clear();
+    assert(copy.IsEmpty());
+
+    // Исключение при добавлении строки не оставляет столбцы разной длины
+    SoAVector<int, ThrowOnCopy> guarded;
+    const ThrowOnCopy bad(-1);
+    try {
+        guarded.PushBack(1, bad);
+        assert(false);
+    } catch (const std::runtime_error&) {
+    }
+    assert(guarded.IsEmpty() && guarded.Column<0>().IsEmpty());
+}
+
+struct StatsPushBackTag {
+    static constexpr const char* kName = "test push back";
+};
+
+struct StatsCopyTag {
+};
+
+inline void TestStatsPolicy() {
+    using Counting = SimpleVector<int, std::allocator<int>, DoublingGrowth, CountingStats<StatsPushBackTag>>;
+    static_assert(sizeof(Counting) == sizeof(SimpleVector<int>), "stats policy must not grow the vector");
+    // Счётчики регистрируются заранее, хуки не выделяют память
+    static_assert(noexcept(CountingStats<StatsPushBackTag>::Counters()));
+
+    const StatsCounters& counters = CountingStats<StatsPushBackTag>::Counters();
+    {
+        Counting v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        // 1 -> 2 -> 4 -> ... -> 128: первое выделение и 7 переносов 1 + 2 + ... + 64 элементов
+        assert(counters.allocations == 1);
+        assert(counters.reallocations == 7);
+        assert(counters.elements_relocated == 127 && counters.bytes_relocated == 127 * sizeof(int));
+        assert(counters.peak_capacity == 128);
+        v.Insert(v.begin(), {1, 2, 3});
+        assert(counters.reallocations == 7);
+        v.Resize(300);
+        assert(counters.reallocations == 8 && counters.elements_relocated == 230);
+        assert(counters.peak_capacity == 300);
+    }
+    assert(counters.releases == 1 && counters.released_size == 300);
+
+    using Copied = SimpleVector<std::string, std::allocator<std::string>, DoublingGrowth, CountingStats<StatsCopyTag>>;
+    {
+        Copied v(10, "x");
+        Copied copy(v);
+        copy = v;
+        const StatsCounters& copy_counters = CountingStats<StatsCopyTag>::Counters();
+        assert(copy_counters.allocations == 3 && copy_counters.elements_copied == 20);
+    }
+
+    std::ostringstream report;
+    StatsRegistry::Instance().Dump(report);
+    assert(report.str().find("test push back 1 8 230/920 0/0 300 1 100") != std::string::npos);
+    assert(report.str().find(typeid(StatsCopyTag).name()) != std::string::npos);
+}
+
+#ifdef SIMPLE_VECTOR_HAS_CONSTEXPR
+// Таблица строится при компиляции тем же iota, что и GenerateVector, и копируется в std::array
+template <size_t N>
+constexpr std::array<int, N> MakeConstexprTable() {
+    SimpleVector<int> v(Reserve(N));
+    for (size_t i = 0; i < N / 2; ++i) {
+        v.PushBack(0);
+    }
+    v.Resize(N);
+    std::iota(v.begin(), v.end(), 1);
+    v.Insert(v.begin(), -1);
+    v.Erase(v.begin());
+    std::array<int, N> table{};
+    std::copy(v.begin(), v.end(), table.begin());
+    return table;
+}
+
+constexpr bool ConstexprOperations() {
+    SimpleVector<int> a{1, 2, 3};
+    SimpleVector<int> b = a;
+    b.PushBack(4);
+    b.Emplace(b.begin() + 1, 10);
+    b.Insert(b.begin(), 2, 7);
+    b.ResizeDefaultInit(8);
+    b.PopBack();
+    SimpleVector<int> c = std::move(b);
+    c.ShrinkToFit();
+    const bool ok = a < c && a != c && c.GetSize() == 7 && c[0] == 7 && c[3] == 10 && c.At(6) == 4;
+    c.Clear();
+    return ok && c.IsEmpty() && Erase(a, 2) == 1 && a == SimpleVector<int>{1, 3};
+}
+
+inline constexpr std::array<int, 100> kConstexprTable = MakeConstexprTable<100>();
+static_assert(kConstexprTable[0] == 1 && kConstexprTable[99] == 100);
+static_assert(ConstexprOperations());
+#endif
+
+inline void TestConstexprSimpleVector() {
+#ifdef SIMPLE_VECTOR_HAS_CONSTEXPR
+    // Те же функции дают тот же результат и во время выполнения
+    assert(MakeConstexprTable<100>() == kConstexprTable);
+    assert(ConstexprOperations());
+#endif
+}
+
+inline void TestStaticVector() {
+    static_assert(std::is_trivially_copyable_v<StaticVector<int, 8>>);
+    static_assert(!std::is_trivially_copyable_v<StaticVector<std::string, 8>>);
+    static_assert(sizeof(StaticVector<int, 8>) == sizeof(size_t) + 8 * sizeof(int));
+
+    // Тривиально копируемые элементы
+    {
+        StaticVector<int, 8> v{1, 2, 3};
+        assert(v.GetSize() == 3 && v.GetCapacity() == 8 && !v.IsFull());
+        v.PushBack(4);
+        v.Insert(v.begin(), 0);
+        v.Erase(v.begin() + 2);
+        assert((v == StaticVector<int, 8>{0, 1, 3, 4}));
+        StaticVector<int, 8> copy;
+        std::memcpy(static_cast<void*>(&copy), &v, sizeof(v));
+        assert(copy == v);
+        v.Resize(8);
+        assert(v.IsFull() && v[7] == 0);
+        assert(!v.TryPushBack(9));
+        try {
+            v.PushBack(9);
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        try {
+            v.Insert(v.begin(), 9);
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        try {
+            v.Resize(9);
+            assert(false);
+        } catch (const std::length_error&) {
+        }
+        try {
+            v.At(8);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        assert(v.GetSize() == 8 && copy < v);
+        v.Erase(v.begin() + 1, v.end() - 1);
+        assert((v == StaticVector<int, 8>{0, 0}));
+    }
+
+    // Нетривиальные элементы
+    {
+        StaticVector<std::string, 4> v(2, "a");
+        assert(v.TryPushBack("b") && v.TryPushBack("c") && !v.TryPushBack("d"));
+        StaticVector<std::string, 4> copy = v;
+        StaticVector<std::string, 4> moved = std::move(copy);
+        assert(moved == v && moved[3] == "c");
+        StaticVector<std::string, 4> other{"x"};
+        other.swap(v);
+        assert(other.GetSize() == 4 && v.GetSize() == 1 && v[0] == "x" && other[0] == "a");
+        v = other;
+        assert(v == other);
+        other.Erase(other.begin());
+        v = std::move(other);
+        assert(v.GetSize() == 3 && v[0] == "a" && v.At(2) == "c");
+        v.Insert(v.begin() + 1, v[2]);
+        assert(v[1] == "c" && v.IsFull());
+        v.Clear();
+        assert(v.IsEmpty());
+    }
+    {
+        {
+            StaticVector<Counted, 16> v(5, Counted(1));
+            v.EmplaceBack(2);
+            StaticVector<Counted, 16> copy = v;
+            copy.PopBack();
+            assert(Counted::alive == 11);
+        }
+        assert(Counted::alive == 0);
+    }
+}
+
+inline void TestFlatSet() {
+    // Политики поиска совпадают с std::lower_bound, включая повторы и края
+    {
+        std::mt19937 gen(42);
+        for(size_t size = 0; size < 70; ++size){
+            std::vector<int> data(size);
+            for(int& x : data){
+                x = static_cast<int>(gen() % 40);
+            }
+            std::sort(data.begin(), data.end());
+            for(int key = -1; key <= 41; ++key){
+                const size_t expected = std::lower_bound(data.begin(), data.end(), key) - data.begin();
+                assert(BinarySearch::LowerBound(data.data(), size, key, std::less<int>()) == expected);
+                assert(BranchlessSearch::LowerBound(data.data(), size, key, std::less<int>()) == expected);
+            }
+        }
+    }
+
+    {
+        FlatSet<int> s{5, 1, 3, 1, 5};
+        assert(s.GetSize() == 3);
+        assert((s.GetKeys() == SimpleVector<int>{1, 3, 5}));
+        auto [it, inserted] = s.Insert(2);
+        assert(inserted && *it == 2 && it == s.begin() + 1);
+        std::tie(it, inserted) = s.Insert(3);
+        assert(!inserted && *it == 3);
+        assert(s.Contains(5) && !s.Contains(4) && s.Count(1) == 1 && s.Count(0) == 0);
+        assert(*s.LowerBound(4) == 5 && *s.UpperBound(3) == 5 && s.UpperBound(5) == s.end());
+        assert(s.Find(4) == s.end());
+        assert(s.Erase(3) == 1 && s.Erase(3) == 0);
+        assert(*s.Erase(s.begin()) == 2);
+        assert((s == FlatSet<int>{2, 5}) && (FlatSet<int>{2, 4} < s));
+    }
+
+    // Пакетная вставка: дубликаты внутри пакета и с имеющимися ключами
+    {
+        using Key = std::pair<int, int>;
+        auto by_first = [](const Key& lhs, const Key& rhs) {
+            return lhs.first < rhs.first;
+        };
+        FlatSet<Key, decltype(by_first), BranchlessSearch> s(by_first);
+        s.Insert({2, 0});
+        s.Insert({4, 0});
+        const std::vector<Key> batch{{3, 1}, {2, 1}, {1, 1}, {3, 2}, {5, 1}, {1, 2}};
+        s.InsertBulk(batch.begin(), batch.end());
+        const std::vector<Key> expected{{1, 1}, {2, 0}, {3, 1}, {4, 0}, {5, 1}};
+        assert(std::equal(s.begin(), s.end(), expected.begin(), expected.end()));
+        s.InsertBulk(batch.begin(), batch.begin());
+        assert(s.GetSize() == 5);
+        assert(s.Find({3, 7}) == s.begin() + 2);
+    }
+    {
+        std::mt19937 gen(7);
+        std::vector<std::string> words;
+        for(int i = 0; i < 500; ++i){
+            words.push_back(std::to_string(gen() % 200));
+        }
+        FlatSet<std::string> s;
+        s.InsertBulk(words.begin(), words.begin() + 250);
+        s.InsertBulk(words.begin() + 250, words.end());
+        std::vector<std::string> expected = words;
+        std::sort(expected.begin(), expected.end());
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+        assert(std::equal(s.begin(), s.end(), expected.begin(), expected.end()));
+        FlatSet<std::string> single;
+        for(const std::string& word : words){
+            single.Insert(word);
+        }
+        assert(single == s);
+    }
+
+    // Ключи, которые при перемещении копируются: исключение при слиянии не портит множество
+    {
+        int budget = -1;
+        auto counting_less = [&budget](const ThrowOnCopy& lhs, const ThrowOnCopy& rhs) {
+            if(budget == 0){
+                throw std::runtime_error("compare");
+            }
+            --budget;
+            return lhs.value < rhs.value;
+        };
+        for(int limit = 0; limit < 12; ++limit){
+            FlatSet<ThrowOnCopy, decltype(counting_less)> s(counting_less);
+            budget = -1;
+            s.Insert(ThrowOnCopy(2));
+            s.Insert(ThrowOnCopy(4));
+            const std::vector<ThrowOnCopy> batch{ThrowOnCopy(5), ThrowOnCopy(3), ThrowOnCopy(1)};
+            budget = limit;
+            try {
+                s.InsertBulk(batch.begin(), batch.end());
+                budget = -1;
+                assert(s.GetSize() == 5);
+            } catch (const std::runtime_error&) {
+                budget = -1;
+                assert(s.GetSize() == 2 && s.begin()->value == 2 && (s.begin() + 1)->value == 4);
+            }
+        }
+        assert(ThrowOnCopy::alive == 0);
+    }
+}
+
+inline void TestFlatMap() {
+    {
+        FlatMap<std::string, int> m{{"b", 2}, {"a", 1}, {"b", 3}};
+        assert(m.GetSize() == 2 && m.At("b") == 2);
+        auto [it, inserted] = m.Insert("c", 3);
+        assert(inserted && (*it).first == "c" && (*it).second == 3);
+        std::tie(it, inserted) = m.Insert("a", 10);
+        assert(!inserted && (*it).second == 1);
+        std::tie(it, inserted) = m.InsertOrAssign("a", 10);
+        assert(!inserted && m.At("a") == 10);
+        m["d"] += 4;
+        ++m["a"];
+        assert(m["d"] == 4 && m.At("a") == 11);
+        try {
+            m.At("z");
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+        assert(m.Contains("c") && !m.Contains("e") && m.Find("e") == m.end());
+        (*m.Find("c")).second = 30;
+        assert(m.Erase("b") == 1 && m.Erase("b") == 0);
+        const std::vector<std::string> keys{"a", "c", "d"};
+        const std::vector<int> values{11, 30, 4};
+        assert(std::equal(m.Keys().begin(), m.Keys().end(), keys.begin(), keys.end()));
+        assert(std::equal(m.Values().begin(), m.Values().end(), values.begin(), values.end()));
+        size_t count = 0;
+        for(const auto [key, value] : std::as_const(m)){
+            assert(key == keys[count] && value == values[count]);
+            ++count;
+        }
+        assert(count == 3);
+        for(auto [key, value] : m){
+            value *= 2;
+        }
+        assert(m.At("d") == 8);
+        FlatMap<std::string, int> copy = m;
+        assert(copy == m);
+        copy.Clear();
+        assert(copy.IsEmpty() && copy != m);
+    }
+
+    // Пакетная вставка сохраняет имеющиеся значения и первое из повторяющихся новых
+    {
+        std::mt19937 gen(3);
+        std::vector<std::pair<int, int>> pairs;
+        for(int i = 0; i < 1000; ++i){
+            pairs.emplace_back(static_cast<int>(gen() % 300), i);
+        }
+        FlatMap<int, int, std::less<int>, BranchlessSearch> bulk;
+        bulk.Insert(7, -1);
+        bulk.InsertBulk(pairs.begin(), pairs.end());
+        FlatMap<int, int, std::less<int>, BranchlessSearch> single;
+        single.Insert(7, -1);
+        for(const auto& [key, value] : pairs){
+            single.Insert(key, value);
+        }
+        assert(bulk == single && bulk.At(7) == -1);
+        assert(std::is_sorted(bulk.Keys().begin(), bulk.Keys().end()));
+    }
+
+    // Тривиальные ключи и копируемые значения: исключение при слиянии не меняет словарь
+    {
+        {
+            FlatMap<int, ThrowOnCopy> m;
+            m.Insert(1, ThrowOnCopy(1));
+            m.Insert(2, ThrowOnCopy(2));
+            m.Values()[1].value = -2;
+            const std::vector<std::pair<int, ThrowOnCopy>> batch{{3, ThrowOnCopy(3)}};
+            try {
+                m.InsertBulk(batch.begin(), batch.end());
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(m.GetSize() == 2 && m.At(1).value == 1 && m.At(2).value == -2);
+        }
+        assert(ThrowOnCopy::alive == 0);
+    }
+
+    // Бросающее сравнение: тривиальные пары сохраняются, перемещённые строки - нет
+    {
+        int budget = -1;
+        auto counting_less = [&budget](const auto& lhs, const auto& rhs) {
+            if(budget == 0){
+                throw std::runtime_error("compare");
+            }
+            --budget;
+            return lhs < rhs;
+        };
+        using Less = decltype(counting_less);
+        FlatMap<int, int, Less> numbers(counting_less);
+        FlatMap<std::string, int, Less> words(counting_less);
+        for(int i = 0; i < 8; i += 2){
+            numbers.Insert(i, i);
+            words.Insert(std::to_string(i), i);
+        }
+        const std::vector<std::pair<int, int>> number_batch{{7, 7}, {3, 3}};
+        const std::vector<std::pair<std::string, int>> word_batch{{"7", 7}, {"3", 3}};
+        // сортировка пакета из двух пар - одно сравнение, второе бросает уже при слиянии
+        budget = 1;
+        try {
+            numbers.InsertBulk(number_batch.begin(), number_batch.end());
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        budget = -1;
+        assert(numbers.GetSize() == 4 && numbers.At(6) == 6);
+        budget = 1;
+        try {
+            words.InsertBulk(word_batch.begin(), word_batch.end());
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        budget = -1;
+        assert(words.IsEmpty());
+    }
+}
@@ -3,10 +3,33 @@ CONFIG += console c++17
 CONFIG -= app_bundle
 CONFIG -= qt
 
+LIBS += -pthread
+
 SOURCES += \
         main.cpp
 
 HEADERS += \
+  aligned_allocator.h \
   array_ptr.h \
+  compact_kernels.h \
+  compare_kernels.h \
+  concurrent_simple_vector.h \
+  constexpr_support.h \
+  cow_simple_vector.h \
+  flat_map.h \
+  flat_search.h \
+  flat_set.h \
+  growth_policy.h \
+  malloc_allocator.h \
+  mapped_simple_vector.h \
+  mmap_allocator.h \
+  parallel.h \
+  segmented_vector.h \
+  serialization.h \
   simple_vector.h \
+  simple_vector_view.h \
+  small_simple_vector.h \
+  soa_vector.h \
+  static_vector.h \
+  stats_policy.h \
   tests.h